@@ -70,6 +70,8 @@ void camera::compute_screen_coordinates(const double init_n, const double init_f
     L = -R;
     T = S;
     B = -T;
+
+	this->projection_changed();
 }
 
 camera::camera(int64_t W, int64_t H) {
@@ -83,8 +85,19 @@ camera::camera(int64_t W, int64_t H, double f) {
     position = vec3<double>(0.0, 0.0, DEFAULT_Z_POS);
 }
 
+void camera::view_changed() {
+	view_dirty = true;
+	++changes;
+}
+
+void camera::projection_changed() {
+	proj_dirty = true;
+	++changes;
+}
+
 void camera::pos(vec3<double> new_pos) {
     position = vec3<double>(new_pos);
+	this->view_changed();
 }
 
 vec3<double> camera::pos() const {
@@ -101,6 +114,60 @@ vec3<double> camera::up() const {
 
 void camera::translate(const vec3<double>& translation) {
     position += translation;
+	this->view_changed();
+}
+
+void camera::orient(vec3<double> front, vec3<double> up) {
+	front_dir = front;
+	up_dir = up;
+	this->view_changed();
+}
+
+double camera::field_of_view() const {
+	return fov;
+}
+
+void camera::field_of_view(double f) {
+	fov = f;
+
+	if (N > 0)
+		this->compute_screen_coordinates(N, F);
+}
+
+const mat4<double>& camera::view() const {
+	if (view_dirty) {
+		view_mat = this->camera_view();
+		view_dirty = false;
+		combined_dirty = true;
+	}
+
+	return view_mat;
+}
+
+const mat4<double>& camera::projection() const {
+	if (proj_dirty) {
+		proj_mat = this->compute_projection();
+		proj_dirty = false;
+		combined_dirty = true;
+	}
+
+	return proj_mat;
+}
+
+const mat4<double>& camera::view_projection() const {
+	const mat4<double> &V = this->view(),
+					   &P = this->projection();
+
+	if (combined_dirty) {
+		view_proj_mat = P * V;
+		combined_dirty = false;
+	}
+
+	return view_proj_mat;
+}
+
+uint64_t camera::version() const {
+	return changes;
 }
 
 mat4<double> camera::compute_projection() const {
@@ -118,4 +185,9 @@ mat4<double> camera::camera_view() const {
 void camera::reset() {
     fov = DEFAULT_CAMERA_FOV;
     position = vec3<double>(0.0, 0.0, DEFAULT_Z_POS);
+
+	if (N > 0)
+		this->compute_screen_coordinates(N, F);
+
+	this->view_changed();
 }
@@ -26,12 +26,22 @@ class camera {
     private:
         double fov, ratio;
         // Near, Far, Right, Left, Top, Bottom Values
-        double N, F, R, L, T, B;
+        double N = 0, F = 0, R = 0, L = 0, T = 0, B = 0;
 
 		// Looks down -z.
         vec3<double> position = vec3<double>(0, 0, DEFAULT_Z_POS),
 					 front_dir = vec3<double>(0, 0, -1), 
 					 up_dir = vec3<double>(0, -1, 0);
+
+		// Rebuilt on first use after a change.
+		mutable mat4<double> view_mat, proj_mat, view_proj_mat;
+		mutable bool view_dirty = true, proj_dirty = true, combined_dirty = true;
+
+		uint64_t changes = 0;
+
+		void view_changed();
+
+		void projection_changed();
     public:
         camera(int64_t W, int64_t H);
 
@@ -51,6 +61,24 @@ class camera {
 
         void translate(const vec3<double>& translate);
 
+		void orient(vec3<double> front,
+					vec3<double> up);
+
+		double field_of_view() const;
+
+		// Degrees; keeps the current near and far planes.
+		void field_of_view(double f);
+
+		// Cached matrices, valid until the camera next changes.
+		const mat4<double>& view() const;
+
+		const mat4<double>& projection() const;
+
+		const mat4<double>& view_projection() const;
+
+		// Increases whenever a cached matrix would change.
+		uint64_t version() const;
+
         mat4<double> compute_projection() const;
 
         template <typename U>
@@ -67,9 +95,8 @@ class camera {
 template <typename U> 
 vec4<double> camera::compute_ndc(vec3<U> vert) const {
     vec4<double> v4 = static_cast<vec4<double>>(vec4<U>(vert));
-    mat4<double> M = this->compute_projection();
 
-    vec4<double> clip = M * v4;
+    vec4<double> clip = this->projection() * v4;
 
     clip /= clip.w();
 
@@ -78,9 +105,7 @@ vec4<double> camera::compute_ndc(vec3<U> vert) const {
 
 template <typename U>
 vec4<double> camera::compute_ndc(vec4<U> vert) const {
-    mat4<double> M = this->compute_projection();
-
-    vec4<double> clip = M * vert;
+    vec4<double> clip = this->projection() * vert;
 
     clip /= clip.w();
 
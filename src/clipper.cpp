@@ -0,0 +1,152 @@
+#include "clipper.hpp"
+
+// Signed distances to the view volume planes, positive inside. Planes 0 and
+// 1 are near and far; 2-5 are the side planes, scaled by the guard band.
+static inline double distance(const clip_vertex &p, int64_t plane, double guard) {
+	switch (plane) {
+		case 0: return p.w + p.z;
+		case 1: return p.w - p.z;
+		case 2: return guard * p.w + p.x;
+		case 3: return guard * p.w - p.x;
+		case 4: return guard * p.w + p.y;
+		default: return guard * p.w - p.y;
+	}
+}
+
+static inline int64_t planes_outside(const clip_vertex &p, double guard) {
+	int64_t code = 0;
+
+	for (int64_t k = 0; k < 6; k++)
+		if (distance(p, k, guard) < 0)
+			code |= (1 << k);
+
+	return code;
+}
+
+int64_t clip_outcode(const clip_vertex &p, double guard) {
+	return planes_outside(p, 1.0) | (planes_outside(p, guard) << CLIP_GUARD_SHIFT);
+}
+
+static inline clip_vertex lerp(const clip_vertex &a, const clip_vertex &b, double t, int64_t varyings) {
+	clip_vertex r;
+
+	r.x = a.x + (b.x - a.x) * t;
+	r.y = a.y + (b.y - a.y) * t;
+	r.z = a.z + (b.z - a.z) * t;
+	r.w = a.w + (b.w - a.w) * t;
+
+	for (int64_t k = 0; k < varyings; k++)
+		r.v[k] = a.v[k] + (b.v[k] - a.v[k]) * t;
+
+	return r;
+}
+
+int64_t clip_triangle(const clip_vertex in[3],
+					  clip_vertex out[CLIP_MAX_VERTICES],
+					  int64_t varyings,
+					  double guard,
+					  bool *clipped) {
+	int64_t codes[3] = { clip_outcode(in[0], guard), clip_outcode(in[1], guard), clip_outcode(in[2], guard) };
+
+	// Rejection uses the real viewport planes, clipping the guard band.
+	if (codes[0] & codes[1] & codes[2] & CLIP_VIEW_MASK)
+		return 0;
+
+	int64_t crossed = (codes[0] | codes[1] | codes[2]) >> CLIP_GUARD_SHIFT;
+
+	if (clipped)
+		*clipped = (crossed != 0);
+
+	out[0] = in[0];
+	out[1] = in[1];
+	out[2] = in[2];
+
+	if (!crossed)
+		return 3;
+
+	clip_vertex buffer[CLIP_MAX_VERTICES];
+	clip_vertex *src = out, *dst = buffer;
+	int64_t N = 3;
+
+	for (int64_t plane = 0; plane < 6 && N >= 3; plane++) {
+		if (!(crossed & (1 << plane)))
+			continue;
+
+		int64_t M = 0;
+
+		for (int64_t k = 0; k < N; k++) {
+			const clip_vertex &a = src[k], &b = src[(k + 1) % N];
+			double da = distance(a, plane, guard),
+				   db = distance(b, plane, guard);
+
+			if (da >= 0)
+				dst[M++] = a;
+
+			if ((da >= 0) != (db >= 0))
+				dst[M++] = lerp(a, b, da / (da - db), varyings);
+		}
+
+		clip_vertex *tmp = src;
+		src = dst;
+		dst = tmp;
+		N = M;
+	}
+
+	if (N < 3)
+		return 0;
+
+	if (src != out)
+		for (int64_t k = 0; k < N; k++)
+			out[k] = src[k];
+
+	return N;
+}
+
+bool clip_line(clip_vertex &a, clip_vertex &b, int64_t varyings) {
+	int64_t ca = planes_outside(a, 1.0), cb = planes_outside(b, 1.0);
+
+	if (ca & cb)
+		return false;
+
+	if (!(ca | cb))
+		return true;
+
+	// Liang-Barsky: shrink [t0, t1] to the part inside every plane.
+	double t0 = 0.0, t1 = 1.0;
+
+	for (int64_t plane = 0; plane < 6; plane++) {
+		double da = distance(a, plane, 1.0),
+			   db = distance(b, plane, 1.0);
+
+		if (da < 0 && db < 0)
+			return false;
+
+		if (da < 0)
+			t0 = MAX(t0, da / (da - db));
+		else if (db < 0)
+			t1 = MIN(t1, da / (da - db));
+	}
+
+	if (t0 > t1)
+		return false;
+
+	clip_vertex A = a;
+
+	if (t0 > 0.0)
+		a = lerp(A, b, t0, varyings);
+
+	if (t1 < 1.0)
+		b = lerp(A, b, t1, varyings);
+
+	return true;
+}
+
+double clip_winding(const clip_vertex V[3]) {
+	return V[0].x * (V[1].y * V[2].w - V[2].y * V[1].w) -
+		   V[1].x * (V[0].y * V[2].w - V[2].y * V[0].w) +
+		   V[2].x * (V[0].y * V[1].w - V[1].y * V[0].w);
+}
+
+bool clip_depth_visible(const clip_vertex &p) {
+	return (p.w > 0 && p.z >= -p.w && p.z <= p.w);
+}
@@ -0,0 +1,59 @@
+#ifndef CLIPPER_HPP
+#define CLIPPER_HPP
+
+#pragma once
+#include "rasterizer.hpp"
+
+#include <stdint.h>
+
+// Side planes are clipped at |x|, |y| <= CLIP_GUARD_BAND * w. Triangles
+// that only cross the viewport edges are left whole; the rasterizer's
+// bounding box already limits them to on-screen pixels.
+#define CLIP_GUARD_BAND 16.0
+
+// A triangle gains at most one vertex per clipping plane.
+#define CLIP_MAX_VERTICES 9
+
+// Outcode bits: the low six are set for view volume planes a vertex is
+// outside of, the next six for the guard band planes. Near and far appear
+// in both.
+#define CLIP_GUARD_SHIFT 6
+#define CLIP_VIEW_MASK 0x3F
+#define CLIP_GUARD_MASK (0x3F << CLIP_GUARD_SHIFT)
+
+// Homogeneous clip-space vertex, after the projection and before the
+// perspective divide, with the varyings that follow it through clipping.
+struct clip_vertex {
+	double x = 0.0, y = 0.0, z = 0.0, w = 1.0;
+	float v[RASTER_MAX_VARYINGS] = {};
+};
+
+int64_t clip_outcode(const clip_vertex &p,
+					 double guard = CLIP_GUARD_BAND);
+
+// Sutherland-Hodgman clipping against the near (z >= -w) and far (z <= w)
+// planes and the guard band. Triangles entirely outside the view volume
+// are rejected without clipping. Writes the visible convex polygon to out
+// and returns its vertex count (0 when nothing is visible). When given,
+// clipped is set to whether any plane actually cut the triangle.
+int64_t clip_triangle(const clip_vertex in[3],
+					  clip_vertex out[CLIP_MAX_VERTICES],
+					  int64_t varyings,
+					  double guard = CLIP_GUARD_BAND,
+					  bool *clipped = nullptr);
+
+// Clips the segment a-b to the view volume, including the side planes.
+// Returns false when nothing is left.
+bool clip_line(clip_vertex &a,
+			   clip_vertex &b,
+			   int64_t varyings = 0);
+
+// Twice the signed NDC area scaled by w0 * w1 * w2, positive when the
+// triangle is counter-clockwise in NDC (x right, y up). Unlike the projected area, the
+// sign stays correct for vertices behind the eye.
+double clip_winding(const clip_vertex V[3]);
+
+// True when the point lies between the near and far planes.
+bool clip_depth_visible(const clip_vertex &p);
+
+#endif
@@ -12,20 +12,20 @@ color::color(uint8_t R, uint8_t G, uint8_t B, uint8_t A) {
     v4 = vec4<uint8_t>(R, G, B, A);
 }
 
-uint8_t color::R() {
-    return (v4)[0];
+uint8_t color::R() const {
+    return v4.x();
 }
 
-uint8_t color::G() {
-    return (v4)[1];
+uint8_t color::G() const {
+    return v4.y();
 }
 
-uint8_t color::B() {
-    return (v4)[2];
+uint8_t color::B() const {
+    return v4.z();
 }
 
-uint8_t color::A() {
-    return (v4)[3];
+uint8_t color::A() const {
+    return v4.w();
 }
 
 void color::R(uint8_t new_red) {
@@ -20,13 +20,13 @@ class color {
 		~color() { 
 		}
 
-        uint8_t R();
+        uint8_t R() const;
 
-        uint8_t G();
+        uint8_t G() const;
 
-        uint8_t B();
+        uint8_t B() const;
 
-        uint8_t A();
+        uint8_t A() const;
 
         void R(uint8_t new_red);
 
@@ -0,0 +1,192 @@
+#include "command_buffer.hpp"
+#include "tile_renderer.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+// Compares by value, as the window reuses one block for every draw.
+static bool same_lighting(const recorded_lighting &a, const raster_lighting &b) {
+	const raster_lighting &A = a.block;
+
+	if (A.count != b.count || A.diffuse[0] != b.diffuse[0] ||
+		A.diffuse[1] != b.diffuse[1] || A.diffuse[2] != b.diffuse[2])
+		return false;
+
+	for (int64_t f = 0; f < RASTER_LIGHT_FIELDS; f++)
+		for (int64_t k = 0; k < b.count; k++)
+			if (A.soa[f * A.stride + k] != b.soa[f * b.stride + k])
+				return false;
+
+	return true;
+}
+
+// Copies the count lights in use, packed to a stride of count.
+static void record_lighting(recorded_lighting &out, const raster_lighting &L) {
+	out.soa.resize(RASTER_LIGHT_FIELDS * L.count);
+
+	for (int64_t f = 0; f < RASTER_LIGHT_FIELDS; f++)
+		for (int64_t k = 0; k < L.count; k++)
+			out.soa[f * L.count + k] = L.soa[f * L.stride + k];
+
+	out.block = L;
+	out.block.stride = L.count;
+	out.block.soa = out.soa.data();
+}
+
+void command_buffer::clear() {
+	commands.clear();
+	triangles.clear();
+	lightings.clear();
+}
+
+int64_t command_buffer::size() const {
+	return commands.size();
+}
+
+bool command_buffer::empty() const {
+	return commands.empty();
+}
+
+void command_buffer::triangle(const raster_triangle &t) {
+	draw_command C;
+
+	C.type = COMMAND_TRIANGLE;
+	C.color = t.flat;
+	C.blend = t.blend;
+	C.triangle = triangles.size();
+
+	triangles.push_back(t);
+	commands.push_back(C);
+
+	if (!t.lighting)
+		return;
+
+	// Triangles of one draw share a block.
+	const raster_lighting &L = *t.lighting;
+
+	if (lightings.empty() || !same_lighting(lightings.back(), L)) {
+		lightings.emplace_back();
+		record_lighting(lightings.back(), L);
+	}
+
+	triangles.back().lighting = &lightings.back().block;
+}
+
+void command_buffer::line(const raster_segment &s,
+						  bool blend,
+						  bool smooth) {
+	draw_command C;
+
+	C.type = COMMAND_LINE;
+	C.blend = blend;
+	C.smooth = smooth;
+	C.segment = s;
+
+	commands.push_back(C);
+}
+
+void command_buffer::point(int64_t x, int64_t y,
+						   uint32_t color,
+						   bool blend) {
+	draw_command C;
+
+	C.type = COMMAND_POINT;
+	C.color = color;
+	C.blend = blend;
+	C.x = x;
+	C.y = y;
+
+	commands.push_back(C);
+}
+
+void command_buffer::disc(const raster_circle &d,
+						  bool blend,
+						  bool smooth) {
+	draw_command C;
+
+	C.type = COMMAND_DISC;
+	C.blend = blend;
+	C.smooth = smooth;
+	C.disc = d;
+
+	commands.push_back(C);
+}
+
+const draw_command& command_buffer::operator[](int64_t idx) const {
+	return commands[idx];
+}
+
+const raster_triangle& command_buffer::triangle_at(int64_t idx) const {
+	return triangles[idx];
+}
+
+// For SORT_STATE, tex numbers the triangle's texture, which keeps the key
+// within the 53 bits a double holds exactly.
+static double sort_key(const raster_triangle &t, command_sort sort, int64_t tex) {
+	switch (sort) {
+		case SORT_STATE:
+			return (double) ((((uint64_t) tex << 4 | (uint64_t) t.filter << 2 | t.shading) << 32) | t.flat);
+		case SORT_DEPTH: {
+			double cx = (t.x0 + t.x1) / 2.0,
+				   cy = (t.y0 + t.y1) / 2.0;
+
+			return t.z.a * cx + t.z.b * cy + t.z.c;
+		}
+		case SORT_TILE:
+			return (double) ((t.y0 / TILE_SIZE) * (RASTER_MAX_COORD / TILE_SIZE) + t.x0 / TILE_SIZE);
+		default:
+			return 0.0;
+	}
+}
+
+void command_buffer::order(command_sort sort,
+						   std::vector<int64_t> &out) const {
+	int64_t N = commands.size();
+
+	out.resize(N);
+
+	for (int64_t k = 0; k < N; k++)
+		out[k] = k;
+
+	if (sort == SORT_SUBMISSION)
+		return;
+
+	std::vector<double> keys(N, 0.0);
+
+	// Textures in order of first use.
+	std::unordered_map<const texture*, int64_t> textures;
+
+	for (int64_t k = 0; k < N; k++) {
+		if (commands[k].type != COMMAND_TRIANGLE)
+			continue;
+
+		const raster_triangle &t = triangles[commands[k].triangle];
+
+		int64_t tex = textures.emplace(t.tex, textures.size()).first->second;
+
+		keys[k] = sort_key(t, sort, tex);
+	}
+
+	auto sortable = [&](int64_t k) {
+		const draw_command &C = commands[k];
+
+		return C.type == COMMAND_TRIANGLE && !C.blend && triangles[C.triangle].depth_test;
+	};
+
+	for (int64_t start = 0; start < N; ) {
+		if (!sortable(start)) {
+			++start;
+			continue;
+		}
+
+		int64_t end = start;
+
+		while (end < N && sortable(end))
+			++end;
+
+		std::stable_sort(out.begin() + start, out.begin() + end,
+						 [&](int64_t a, int64_t b) { return keys[a] < keys[b]; });
+
+		start = end;
+	}
+}
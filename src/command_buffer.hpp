@@ -0,0 +1,98 @@
+#ifndef COMMAND_BUFFER_HPP
+#define COMMAND_BUFFER_HPP
+
+#pragma once
+#include "rasterizer.hpp"
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+enum command_type {
+	COMMAND_TRIANGLE,
+	COMMAND_LINE,
+	COMMAND_POINT,
+	COMMAND_DISC
+};
+
+enum command_sort {
+	SORT_SUBMISSION,
+	// Groups triangles sharing texture, shading and color.
+	SORT_STATE,
+	// Front to back, by depth at the bounding box center.
+	SORT_DEPTH,
+	// Row-major by the tile holding the bounding box corner.
+	SORT_TILE
+};
+
+// Screen space primitive, after transform, clipping and set-up.
+struct draw_command {
+	command_type type;
+	// Of points; lines and discs carry their own.
+	uint32_t color = 0;
+	bool blend = false;
+	// Anti-aliased lines and discs, which always blend.
+	bool smooth = false;
+	int64_t x = 0, y = 0;
+	raster_segment segment;
+	raster_circle disc;
+	// Into the buffer's triangles.
+	int64_t triangle = -1;
+};
+
+// A recorded triangle's lighting, with the light arrays copied out of the
+// light_list so later light or eye changes do not reach it.
+struct recorded_lighting {
+	raster_lighting block;
+	std::vector<float> soa;
+};
+
+// Records primitives so a static scene can be replayed without repeating
+// its geometry processing. Only opaque depth-tested triangles are
+// reordered by a sort; anything else keeps its place and splits the
+// triangles around it into separately sorted runs, so the output matches
+// submission order. Recorded triangles point at the buffer's own copy of
+// their lighting, so replay does not depend on the draw that made them.
+class command_buffer {
+	private:
+		std::vector<draw_command> commands;
+		std::vector<raster_triangle> triangles;
+		// A deque, as triangles keep pointers into it.
+		std::deque<recorded_lighting> lightings;
+	public:
+		command_buffer() {}
+
+		command_buffer(const command_buffer &buffer) = delete;
+
+		~command_buffer() {}
+
+		void clear();
+
+		int64_t size() const;
+
+		bool empty() const;
+
+		void triangle(const raster_triangle &t);
+
+		void line(const raster_segment &s,
+				  bool blend = false,
+				  bool smooth = false);
+
+		void point(int64_t x, int64_t y,
+				   uint32_t color,
+				   bool blend = false);
+
+		void disc(const raster_circle &d,
+				  bool blend = false,
+				  bool smooth = false);
+
+		const draw_command& operator[](int64_t idx) const;
+
+		const raster_triangle& triangle_at(int64_t idx) const;
+
+		// Command indices in replay order.
+		void order(command_sort sort,
+				   std::vector<int64_t> &out) const;
+};
+
+#endif
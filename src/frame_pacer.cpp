@@ -0,0 +1,96 @@
+#include "frame_pacer.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+frame_pacer::frame_pacer(double fps) {
+	this->frame_rate(fps);
+}
+
+pacing_mode frame_pacer::mode() const {
+	return pacing;
+}
+
+void frame_pacer::frame_rate(double fps) {
+	if (fps <= 0) {
+		this->uncapped();
+		return;
+	}
+
+	pacing = PACE_FIXED;
+	budget = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / fps));
+	started = false;
+}
+
+void frame_pacer::uncapped() {
+	pacing = PACE_UNCAPPED;
+}
+
+void frame_pacer::vsync() {
+	pacing = PACE_VSYNC;
+}
+
+void frame_pacer::wait() {
+	clock::time_point now = clock::now();
+
+	if (!started) {
+		started = true;
+		last = now;
+		deadline = now + budget;
+		return;
+	}
+
+	double work = std::chrono::duration<double, std::milli>(now - last).count();
+
+	if (pacing == PACE_FIXED) {
+		if (now < deadline) {
+			std::this_thread::sleep_until(deadline);
+			deadline += budget;
+		} else {
+			deadline = now + budget;
+		}
+
+		now = clock::now();
+	}
+
+	int64_t slot = frames % FRAME_HISTORY;
+
+	times[slot] = std::chrono::duration<double, std::milli>(now - last).count();
+	works[slot] = work;
+
+	++frames;
+	last = now;
+}
+
+frame_stats frame_pacer::stats() const {
+	frame_stats S;
+	int64_t N = std::min(frames, (int64_t) FRAME_HISTORY);
+
+	if (N == 0)
+		return S;
+
+	std::vector<double> sorted(times, times + N);
+	std::sort(sorted.begin(), sorted.end());
+
+	for (int64_t k = 0; k < N; k++) {
+		S.mean += times[k];
+		S.work += works[k];
+	}
+
+	S.frames = frames;
+	S.mean /= N;
+	S.work /= N;
+	S.min = sorted.front();
+	S.max = sorted.back();
+	S.p50 = sorted[(N - 1) * 50 / 100];
+	S.p95 = sorted[(N - 1) * 95 / 100];
+	S.p99 = sorted[(N - 1) * 99 / 100];
+
+	return S;
+}
+
+void frame_pacer::reset() {
+	frames = 0;
+	started = false;
+}
@@ -0,0 +1,67 @@
+#ifndef FRAME_PACER_HPP
+#define FRAME_PACER_HPP
+
+#pragma once
+#include <chrono>
+#include <stdint.h>
+
+#define DEFAULT_FRAME_RATE 60
+
+// Frame times kept for the distribution.
+#define FRAME_HISTORY 1024
+
+enum pacing_mode {
+	// No waiting at all, for benchmarks.
+	PACE_UNCAPPED,
+	// Sleeps until each frame's deadline.
+	PACE_FIXED,
+	// The render target blocks on the display's refresh instead.
+	PACE_VSYNC
+};
+
+// Milliseconds over the recorded frames. Frame time is present to
+// present; work time is the part spent before waiting.
+struct frame_stats {
+	int64_t frames = 0;
+	double mean = 0, min = 0, max = 0,
+		   p50 = 0, p95 = 0, p99 = 0,
+		   work = 0;
+};
+
+// Paces frames against deadlines spaced one budget apart, so a frame only
+// sleeps for what is left of its budget. A frame that overruns moves the
+// next deadline on from now rather than trying to catch up.
+class frame_pacer {
+	private:
+		typedef std::chrono::steady_clock clock;
+
+		pacing_mode pacing = PACE_FIXED;
+		clock::duration budget = clock::duration::zero();
+		clock::time_point deadline, last;
+		bool started = false;
+
+		double times[FRAME_HISTORY], works[FRAME_HISTORY];
+		int64_t frames = 0;
+	public:
+		frame_pacer(double fps = DEFAULT_FRAME_RATE);
+
+		~frame_pacer() {}
+
+		pacing_mode mode() const;
+
+		// fps <= 0 uncaps.
+		void frame_rate(double fps);
+
+		void uncapped();
+
+		void vsync();
+
+		// Call once per frame, right after presenting.
+		void wait();
+
+		frame_stats stats() const;
+
+		void reset();
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include "framebuffer.hpp"
+
+#include <limits>
+#include <utility>
+
+framebuffer::framebuffer(int64_t W, int64_t H) : W(W), H(H) {
+	this->pixels = static_cast<uint32_t*>(malloc(sizeof(uint32_t) * W * H));
+	this->depths = static_cast<float*>(malloc(sizeof(float) * W * H));
+	this->clear(0);
+	this->clear_depth();
+}
+
+framebuffer::~framebuffer() {
+	free(pixels);
+	free(depths);
+	pixels = nullptr;
+	depths = nullptr;
+}
+
+void framebuffer::clear(uint32_t c) {
+	int64_t N = W * H;
+
+	for (int64_t k = 0; k < N; k++)
+		pixels[k] = c;
+}
+
+void framebuffer::clear_depth() {
+	int64_t N = W * H;
+	float far = std::numeric_limits<float>::infinity();
+
+	for (int64_t k = 0; k < N; k++)
+		depths[k] = far;
+}
+
+void framebuffer::hline(int64_t x1, int64_t x2, int64_t y, uint32_t c, bool blended) {
+	if (y < 0 || y >= H)
+		return;
+
+	if (x1 > x2)
+		std::swap(x1, x2);
+
+	x1 = MAX(x1, (int64_t) 0);
+	x2 = MIN(x2, W - 1);
+
+	uint32_t *p = this->row(y);
+
+	if (blended) {
+		for (int64_t x = x1; x <= x2; x++)
+			p[x] = blend_color(p[x], c);
+	} else {
+		for (int64_t x = x1; x <= x2; x++)
+			p[x] = c;
+	}
+}
@@ -0,0 +1,128 @@
+#ifndef FRAMEBUFFER_HPP
+#define FRAMEBUFFER_HPP
+
+#pragma once
+#include "MACROS.hpp"
+#include "color.hpp"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Packs a color as RGBA8 bytes (R in the lowest byte), which is
+// SDL_PIXELFORMAT_ABGR8888 when read back as a uint32_t.
+inline uint32_t pack_color(color c) {
+	return static_cast<uint32_t>(c.R()) |
+		   static_cast<uint32_t>(c.G()) << 8 |
+		   static_cast<uint32_t>(c.B()) << 16 |
+		   static_cast<uint32_t>(c.A()) << 24;
+}
+
+// Source-over blend of src onto dst by src's alpha. The result is opaque.
+// R and B share one multiply; x / 255 is rounded per 16 bit lane as
+// (x + 128 + ((x + 128) >> 8)) >> 8 so neither lane carries into the other.
+inline uint32_t blend_color(uint32_t dst, uint32_t src) {
+	uint32_t a = src >> 24, ia = 255 - a;
+
+	uint32_t rb = (src & 0x00FF00FF) * a + (dst & 0x00FF00FF) * ia + 0x00800080;
+	uint32_t g = ((src >> 8) & 0xFF) * a + ((dst >> 8) & 0xFF) * ia + 0x80;
+
+	rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+	g = (g + (g >> 8)) >> 8;
+
+	return rb | (g << 8) | 0xFF000000;
+}
+
+// src with its alpha scaled by coverage in [0, 1], for anti-aliased edges.
+inline uint32_t cover_color(uint32_t src, double coverage) {
+	uint32_t a = static_cast<uint32_t>((src >> 24) * coverage + 0.5);
+
+	return (src & 0x00FFFFFF) | (a << 24);
+}
+
+// CPU-owned RGBA8 color buffer that every draw call rasterizes into,
+// paired with a float depth buffer holding NDC z (smaller is closer).
+class framebuffer {
+	private:
+		int64_t W, H;
+		uint32_t *pixels;
+		float *depths;
+	public:
+		framebuffer(int64_t W, int64_t H);
+
+		framebuffer(const framebuffer &fb) = delete;
+
+		~framebuffer();
+
+		int64_t width() const;
+
+		int64_t height() const;
+
+		// Bytes per row.
+		int64_t pitch() const;
+
+		uint32_t *data() const;
+
+		uint32_t *row(int64_t y) const;
+
+		float *depth() const;
+
+		float *depth_row(int64_t y) const;
+
+		void clear(uint32_t c);
+
+		void clear_depth();
+
+		bool contains(int64_t x, int64_t y) const;
+
+		void set(int64_t x, int64_t y, uint32_t c);
+
+		void blend(int64_t x, int64_t y, uint32_t c);
+
+		// Writes the span [x1, x2] on row y, clipped to the buffer.
+		void hline(int64_t x1, int64_t x2, int64_t y, uint32_t c,
+				   bool blended = false);
+};
+
+inline int64_t framebuffer::width() const {
+	return W;
+}
+
+inline int64_t framebuffer::height() const {
+	return H;
+}
+
+inline int64_t framebuffer::pitch() const {
+	return W * static_cast<int64_t>(sizeof(uint32_t));
+}
+
+inline uint32_t *framebuffer::data() const {
+	return pixels;
+}
+
+inline uint32_t *framebuffer::row(int64_t y) const {
+	return pixels + y * W;
+}
+
+inline float *framebuffer::depth() const {
+	return depths;
+}
+
+inline float *framebuffer::depth_row(int64_t y) const {
+	return depths + y * W;
+}
+
+inline bool framebuffer::contains(int64_t x, int64_t y) const {
+	return (x >= 0 && y >= 0 && x < W && y < H);
+}
+
+inline void framebuffer::set(int64_t x, int64_t y, uint32_t c) {
+	if (this->contains(x, y))
+		pixels[y * W + x] = c;
+}
+
+inline void framebuffer::blend(int64_t x, int64_t y, uint32_t c) {
+	if (this->contains(x, y))
+		pixels[y * W + x] = blend_color(pixels[y * W + x], c);
+}
+
+#endif
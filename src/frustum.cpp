@@ -0,0 +1,48 @@
+#include "frustum.hpp"
+
+frustum::frustum() {
+	for (int64_t k = 0; k < 6; k++) {
+		P[k][0] = P[k][1] = P[k][2] = 0.0;
+		P[k][3] = 1.0;
+	}
+}
+
+frustum::frustum(const mat4<double>& view_proj) {
+	// Rows 0-2 are added to and subtracted from row 3: left, right, bottom,
+	// top, near, far.
+	for (int64_t k = 0; k < 6; k++) {
+		vec4<double> &R = view_proj[k / 2];
+		double sign = (k % 2 ? -1.0 : 1.0);
+
+		for (int64_t j = 0; j < 4; j++)
+			P[k][j] = view_proj[3][j] + sign * R[j];
+
+		double length = sqrt(P[k][0] * P[k][0] + P[k][1] * P[k][1] + P[k][2] * P[k][2]);
+
+		for (int64_t j = 0; j < 4; j++)
+			P[k][j] /= length;
+	}
+}
+
+bool frustum::sphere_visible(const vec3<double>& center,
+							 const double radius) const {
+	for (int64_t k = 0; k < 6; k++)
+		if (P[k][0] * center.x() + P[k][1] * center.y() + P[k][2] * center.z() + P[k][3] < -radius)
+			return false;
+
+	return true;
+}
+
+bool frustum::box_visible(const vec3<double>& lo,
+						  const vec3<double>& hi) const {
+	for (int64_t k = 0; k < 6; k++) {
+		double x = (P[k][0] >= 0 ? hi.x() : lo.x()),
+			   y = (P[k][1] >= 0 ? hi.y() : lo.y()),
+			   z = (P[k][2] >= 0 ? hi.z() : lo.z());
+
+		if (P[k][0] * x + P[k][1] * y + P[k][2] * z + P[k][3] < 0)
+			return false;
+	}
+
+	return true;
+}
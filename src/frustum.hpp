@@ -0,0 +1,33 @@
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#pragma once
+#include "mat.hpp"
+#include "vec.hpp"
+
+#include <math.h>
+#include <stdint.h>
+
+// The six view volume planes in world space, extracted from a
+// view-projection matrix (Gribb-Hartmann). Normals point inwards and are
+// unit length, so plane values are signed distances.
+class frustum {
+	private:
+		double P[6][4];
+	public:
+		// Accepts everything.
+		frustum();
+
+		frustum(const mat4<double>& view_proj);
+
+		~frustum() {}
+
+		bool sphere_visible(const vec3<double>& center,
+							const double radius) const;
+
+		// Tests the box corner furthest along each plane normal.
+		bool box_visible(const vec3<double>& lo,
+						 const vec3<double>& hi) const;
+};
+
+#endif
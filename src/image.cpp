@@ -0,0 +1,153 @@
+#include "image.hpp"
+
+#include <fstream>
+#include <vector>
+
+static bool write_bytes(const std::vector<uint8_t> &bytes, const std::string &fn) {
+	std::ofstream out(fn, std::ios::binary);
+
+	if (!out.is_open())
+		return false;
+
+	out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+
+	return out.good();
+}
+
+static void push_be32(std::vector<uint8_t> &bytes, uint32_t v) {
+	bytes.push_back(v >> 24);
+	bytes.push_back(v >> 16);
+	bytes.push_back(v >> 8);
+	bytes.push_back(v);
+}
+
+bool write_ppm(const framebuffer &fb, const std::string &fn) {
+	std::string header = "P6\n" + std::to_string(fb.width()) + " " + std::to_string(fb.height()) + "\n255\n";
+	std::vector<uint8_t> bytes(header.begin(), header.end());
+
+	int64_t N = fb.width() * fb.height();
+	const uint32_t *p = fb.data();
+
+	bytes.reserve(bytes.size() + N * 3);
+
+	for (int64_t k = 0; k < N; k++) {
+		bytes.push_back(p[k]);
+		bytes.push_back(p[k] >> 8);
+		bytes.push_back(p[k] >> 16);
+	}
+
+	return write_bytes(bytes, fn);
+}
+
+// Encoder for https://qoiformat.org/qoi-specification.pdf. Pixels are
+// already RGBA bytes, so they are compared and hashed as packed words.
+bool write_qoi(const framebuffer &fb, const std::string &fn) {
+	std::vector<uint8_t> bytes = { 'q', 'o', 'i', 'f' };
+
+	push_be32(bytes, fb.width());
+	push_be32(bytes, fb.height());
+	bytes.push_back(4);
+	bytes.push_back(0);
+
+	uint32_t index[64] = {};
+	uint32_t prev = 0xFF000000;
+	int64_t run = 0, N = fb.width() * fb.height();
+	const uint32_t *p = fb.data();
+
+	for (int64_t k = 0; k < N; k++) {
+		uint32_t px = p[k];
+
+		if (px == prev) {
+			if (++run == 62 || k == N - 1) {
+				bytes.push_back(0xC0 | (run - 1));
+				run = 0;
+			}
+
+			continue;
+		}
+
+		if (run > 0) {
+			bytes.push_back(0xC0 | (run - 1));
+			run = 0;
+		}
+
+		uint8_t r = px, g = px >> 8, b = px >> 16, a = px >> 24;
+		uint32_t hash = (r * 3 + g * 5 + b * 7 + a * 11) % 64;
+
+		if (index[hash] == px) {
+			bytes.push_back(hash);
+		} else if (a != (prev >> 24)) {
+			index[hash] = px;
+			bytes.insert(bytes.end(), { 0xFF, r, g, b, a });
+		} else {
+			index[hash] = px;
+
+			int8_t dr = r - (uint8_t) prev,
+				   dg = g - (uint8_t) (prev >> 8),
+				   db = b - (uint8_t) (prev >> 16);
+			int8_t dr_dg = dr - dg, db_dg = db - dg;
+
+			if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+				bytes.push_back(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+			else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7)
+				bytes.insert(bytes.end(), { (uint8_t) (0x80 | (dg + 32)), (uint8_t) ((dr_dg + 8) << 4 | (db_dg + 8)) });
+			else
+				bytes.insert(bytes.end(), { 0xFE, r, g, b });
+		}
+
+		prev = px;
+	}
+
+	bytes.insert(bytes.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+
+	return write_bytes(bytes, fn);
+}
+
+bool write_image(const framebuffer &fb, const std::string &fn, image_format format) {
+	if (format == IMAGE_QOI)
+		return write_qoi(fb, fn);
+
+	return write_ppm(fb, fn);
+}
+
+bool read_ppm(const std::string &fn, int64_t &W, int64_t &H, std::vector<uint32_t> &pixels) {
+	std::ifstream in(fn, std::ios::binary);
+	std::string magic;
+	int64_t depth = 0;
+
+	if (!in.is_open() || !(in >> magic) || magic != "P6")
+		return false;
+
+	// Width, height and depth, each possibly preceded by comments.
+	int64_t *fields[3] = { &W, &H, &depth };
+
+	for (int64_t k = 0; k < 3; k++) {
+		in >> std::ws;
+
+		while (in.peek() == '#') {
+			in.ignore(INT32_MAX, '\n');
+			in >> std::ws;
+		}
+
+		if (!(in >> *fields[k]))
+			return false;
+	}
+
+	if (W <= 0 || H <= 0 || depth != 255)
+		return false;
+
+	in.get();
+
+	std::vector<uint8_t> bytes(W * H * 3);
+	in.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+
+	if (in.gcount() != (std::streamsize) bytes.size())
+		return false;
+
+	pixels.resize(W * H);
+
+	for (int64_t k = 0; k < W * H; k++)
+		pixels[k] = bytes[3 * k] | bytes[3 * k + 1] << 8 | bytes[3 * k + 2] << 16 | 0xFF000000;
+
+	return true;
+}
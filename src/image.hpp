@@ -0,0 +1,29 @@
+#ifndef IMAGE_HPP
+#define IMAGE_HPP
+
+#pragma once
+#include "framebuffer.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+enum image_format {
+	// Binary P6, RGB only.
+	IMAGE_PPM,
+	// Quite OK Image format, RGBA, losslessly compressed.
+	IMAGE_QOI
+};
+
+// Writes the framebuffer's colors to fn, returning false on I/O errors.
+bool write_ppm(const framebuffer &fb, const std::string &fn);
+
+bool write_qoi(const framebuffer &fb, const std::string &fn);
+
+bool write_image(const framebuffer &fb, const std::string &fn, image_format format);
+
+// Reads a binary (P6, 8-bit) PPM into opaque framebuffer-order pixels,
+// returning false when fn is missing or not in that format.
+bool read_ppm(const std::string &fn, int64_t &W, int64_t &H, std::vector<uint32_t> &pixels);
+
+#endif
@@ -8,8 +8,16 @@ light::light(vec3<double> &p) {
 	this->position = p;
 }
 
-light::light(light &l) {
+light::light(const light &l) {
+	this->kind = l.type();
 	this->position = l.pos();
+	this->axis = l.direction();
+	this->tint = l.intensity();
+	this->spec = l.specular();
+	this->shine = l.shininess();
+	this->reach = l.range();
+	this->inner = l.cone_inner();
+	this->outer = l.cone_outer();
 }
 
 light::~light() {}
@@ -26,10 +34,97 @@ vec3<double> light::norm_pos() const {
 	return this->position.normalize();
 }
 
+light light::point(const vec3<double> &p,
+				   double range) {
+	light L;
+
+	L.kind = LIGHT_POINT;
+	L.position = p;
+	L.reach = range;
+
+	return L;
+}
+
+light light::spot(const vec3<double> &p,
+				  const vec3<double> &direction,
+				  double inner,
+				  double outer,
+				  double range) {
+	light L = light::point(p, range);
+
+	L.kind = LIGHT_SPOT;
+	L.axis = direction;
+	L.cone(inner, outer);
+
+	return L;
+}
+
+void light::type(light_type t) {
+	this->kind = t;
+}
+
+light_type light::type() const {
+	return this->kind;
+}
+
+void light::direction(const vec3<double> &d) {
+	this->axis = d;
+}
+
+vec3<double> light::direction() const {
+	return this->axis;
+}
+
+void light::range(double r) {
+	this->reach = r;
+}
+
+double light::range() const {
+	return this->reach;
+}
+
+void light::cone(double inner_angle, double outer_angle) {
+	this->inner = inner_angle;
+	this->outer = outer_angle;
+}
+
+double light::cone_inner() const {
+	return this->inner;
+}
+
+double light::cone_outer() const {
+	return this->outer;
+}
+
+void light::intensity(const color &c) {
+	this->tint = c;
+}
+
+color light::intensity() const {
+	return this->tint;
+}
+
+void light::specular(const color &c) {
+	this->spec = c;
+}
+
+color light::specular() const {
+	return this->spec;
+}
+
+void light::shininess(double s) {
+	this->shine = s;
+}
+
+double light::shininess() const {
+	return this->shine;
+}
+
 color light::diffuse(const vec3<double> &L,
 					 const vec3<double> &N,
 					 color &c) {
-	double cos = L * N;
+	// Faces turned away from the light get no diffuse term.
+	double cos = MIN(MAX(L * N, 0.0), 1.0);
 	return color(c.R() * cos, c.G() * cos, c.B() * cos, c.A());
 }
 
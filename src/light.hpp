@@ -6,15 +6,28 @@
 #include "color.hpp"
 #include "vec.hpp"
 
+enum light_type {
+	// Lights every point from the same direction, pos() pointing towards
+	// the light.
+	LIGHT_DIRECTIONAL,
+	LIGHT_POINT,
+	// A point light limited to a cone around direction().
+	LIGHT_SPOT
+};
+
 class light {
 	private:
-		vec3<double> position;
+		light_type kind = LIGHT_DIRECTIONAL;
+		vec3<double> position, axis = vec3<double>(0.0, 0.0, -1.0);
+		color tint = color(0xFF, 0xFF, 0xFF),
+			  spec = color(0xFF, 0xFF, 0xFF);
+		double shine = 32.0, reach = 0.0, inner = 0.0, outer = 0.0;
 	public:
 		light();
 
 		light(vec3<double> &p);
 
-		light(light &l);
+		light(const light &l);
 
 		~light();
 
@@ -24,6 +37,52 @@ class light {
 
 		vec3<double> norm_pos() const;
 
+		// Falls off to nothing at range for point and spot lights; 0 never
+		// falls off.
+		static light point(const vec3<double> &p,
+						   double range = 0.0);
+
+		// Full intensity within inner radians of the direction, none past
+		// outer.
+		static light spot(const vec3<double> &p,
+						  const vec3<double> &direction,
+						  double inner,
+						  double outer,
+						  double range = 0.0);
+
+		void type(light_type t);
+
+		light_type type() const;
+
+		void direction(const vec3<double> &d);
+
+		vec3<double> direction() const;
+
+		void range(double r);
+
+		double range() const;
+
+		void cone(double inner_angle, double outer_angle);
+
+		double cone_inner() const;
+
+		double cone_outer() const;
+
+		// Diffuse color.
+		void intensity(const color &c);
+
+		color intensity() const;
+
+		// Blinn-Phong highlight color and exponent.
+		void specular(const color &c);
+
+		color specular() const;
+
+		void shininess(double s);
+
+		double shininess() const;
+
+		// Lambert term for unit vectors L (towards the light) and N.
 		static color diffuse(const vec3<double> &L,
 							 const vec3<double> &N,
 							 color &c);
@@ -0,0 +1,245 @@
+#include "light_list.hpp"
+
+#include <math.h>
+
+void light_batch::resize(int64_t N) {
+	for (std::vector<float> *v : { &nx, &ny, &nz, &ex, &ey, &ez, &r, &g, &b })
+		v->resize(N);
+}
+
+void light_batch::set(int64_t idx,
+					  const vec3<double> &n,
+					  const vec3<double> &e) {
+	nx[idx] = n.x();
+	ny[idx] = n.y();
+	nz[idx] = n.z();
+	ex[idx] = e.x();
+	ey[idx] = e.y();
+	ez[idx] = e.z();
+}
+
+int64_t light_batch::size() const {
+	return nx.size();
+}
+
+int64_t light_list::add(const light &l) {
+	this->lights.push_back(l);
+	this->dirty = true;
+
+	return this->lights.size() - 1;
+}
+
+void light_list::set(int64_t idx, const light &l) {
+	assert(("Index Error: Light index out of range.", idx >= 0 && idx < this->size()));
+
+	this->lights[idx] = l;
+	this->dirty = true;
+}
+
+const light& light_list::get(int64_t idx) const {
+	assert(("Index Error: Light index out of range.", idx >= 0 && idx < this->size()));
+
+	return this->lights[idx];
+}
+
+void light_list::remove(int64_t idx) {
+	assert(("Index Error: Light index out of range.", idx >= 0 && idx < this->size()));
+
+	this->lights.erase(this->lights.begin() + idx);
+	this->dirty = true;
+}
+
+void light_list::clear() {
+	this->lights.clear();
+	this->dirty = true;
+}
+
+int64_t light_list::size() const {
+	return this->lights.size();
+}
+
+void light_list::use_simd(bool enabled) {
+	this->simd = enabled;
+}
+
+void light_list::update(const vec3<double> &eye_position) {
+	if (!this->dirty && eye_position == this->eye)
+		return;
+
+	int64_t N = this->size();
+
+	if (N > this->capacity) {
+		this->capacity = N;
+		this->soa.resize(RASTER_LIGHT_FIELDS * N);
+	}
+
+	const int64_t S = this->capacity;
+
+	for (int64_t k = 0; k < N; k++) {
+		const light &l = this->lights[k];
+		float *F = this->soa.data() + k;
+
+		vec3<double> p = l.pos();
+		double w = 1.0;
+
+		if (l.type() == LIGHT_DIRECTIONAL) {
+			p = l.norm_pos();
+			w = 0.0;
+		} else {
+			p -= eye_position;
+		}
+
+		F[RASTER_LIGHT_X * S] = p.x();
+		F[RASTER_LIGHT_Y * S] = p.y();
+		F[RASTER_LIGHT_Z * S] = p.z();
+		F[RASTER_LIGHT_W * S] = w;
+
+		vec3<double> axis;
+		double scale = 0.0, bias = 1.0;
+
+		if (l.type() == LIGHT_SPOT) {
+			axis = l.direction().normalize();
+
+			double ci = cos(l.cone_inner()), co = cos(l.cone_outer());
+
+			scale = 1.0 / MAX(ci - co, 1e-6);
+			bias = -co * scale;
+		}
+
+		F[RASTER_LIGHT_AXIS_X * S] = axis.x();
+		F[RASTER_LIGHT_AXIS_Y * S] = axis.y();
+		F[RASTER_LIGHT_AXIS_Z * S] = axis.z();
+		F[RASTER_LIGHT_CONE_SCALE * S] = scale;
+		F[RASTER_LIGHT_CONE_BIAS * S] = bias;
+
+		F[RASTER_LIGHT_INV_RANGE2 * S] = (w > 0.0 && l.range() > 0.0 ? 1.0 / (l.range() * l.range()) : 0.0);
+
+		color c = l.intensity(), s = l.specular();
+
+		F[RASTER_LIGHT_R * S] = c.R() / 255.0f;
+		F[RASTER_LIGHT_G * S] = c.G() / 255.0f;
+		F[RASTER_LIGHT_B * S] = c.B() / 255.0f;
+		F[RASTER_LIGHT_SPECULAR_R * S] = s.R() / 255.0f;
+		F[RASTER_LIGHT_SPECULAR_G * S] = s.G() / 255.0f;
+		F[RASTER_LIGHT_SPECULAR_B * S] = s.B() / 255.0f;
+		F[RASTER_LIGHT_SHININESS * S] = l.shininess();
+	}
+
+	this->eye = eye_position;
+	this->dirty = false;
+}
+
+raster_lighting light_list::lighting(const color &surface) const {
+	raster_lighting P;
+
+	P.count = this->size();
+	P.stride = this->capacity;
+	P.soa = this->soa.data();
+	P.diffuse[0] = surface.R();
+	P.diffuse[1] = surface.G();
+	P.diffuse[2] = surface.B();
+
+	return P;
+}
+
+#ifdef RASTER_X86
+#include <immintrin.h>
+
+// Eight points of one light per iteration; the rest go to the scalar loop.
+__attribute__((target("avx2,fma")))
+static int64_t diffuse_avx2(const float *F, int64_t S, int64_t N,
+							const float *nx, const float *ny, const float *nz,
+							const float *ex, const float *ey, const float *ez,
+							float *r, float *g, float *b) {
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f),
+				 X = _mm256_set1_ps(F[RASTER_LIGHT_X * S]), Y = _mm256_set1_ps(F[RASTER_LIGHT_Y * S]),
+				 Z = _mm256_set1_ps(F[RASTER_LIGHT_Z * S]), W = _mm256_set1_ps(F[RASTER_LIGHT_W * S]),
+				 AX = _mm256_set1_ps(-F[RASTER_LIGHT_AXIS_X * S]), AY = _mm256_set1_ps(-F[RASTER_LIGHT_AXIS_Y * S]),
+				 AZ = _mm256_set1_ps(-F[RASTER_LIGHT_AXIS_Z * S]),
+				 scale = _mm256_set1_ps(F[RASTER_LIGHT_CONE_SCALE * S]), bias = _mm256_set1_ps(F[RASTER_LIGHT_CONE_BIAS * S]),
+				 inv_range2 = _mm256_set1_ps(F[RASTER_LIGHT_INV_RANGE2 * S]),
+				 R = _mm256_set1_ps(F[RASTER_LIGHT_R * S]), G = _mm256_set1_ps(F[RASTER_LIGHT_G * S]),
+				 B = _mm256_set1_ps(F[RASTER_LIGHT_B * S]);
+
+	int64_t j = 0;
+
+	for (; j + 8 <= N; j += 8) {
+		__m256 Lx = _mm256_fmadd_ps(W, _mm256_loadu_ps(ex + j), X),
+			   Ly = _mm256_fmadd_ps(W, _mm256_loadu_ps(ey + j), Y),
+			   Lz = _mm256_fmadd_ps(W, _mm256_loadu_ps(ez + j), Z);
+
+		__m256 d2 = _mm256_fmadd_ps(Lx, Lx, _mm256_fmadd_ps(Ly, Ly, _mm256_fmadd_ps(Lz, Lz, _mm256_set1_ps(1e-12f)))),
+			   il = _mm256_div_ps(one, _mm256_sqrt_ps(d2));
+
+		Lx = _mm256_mul_ps(Lx, il);
+		Ly = _mm256_mul_ps(Ly, il);
+		Lz = _mm256_mul_ps(Lz, il);
+
+		__m256 cone = _mm256_fmadd_ps(Lx, AX, _mm256_fmadd_ps(Ly, AY, _mm256_mul_ps(Lz, AZ)));
+		cone = _mm256_min_ps(_mm256_max_ps(_mm256_fmadd_ps(cone, scale, bias), zero), one);
+
+		__m256 fall = _mm256_max_ps(_mm256_fnmadd_ps(d2, inv_range2, one), zero);
+
+		__m256 d = _mm256_fmadd_ps(_mm256_loadu_ps(nx + j), Lx,
+								   _mm256_fmadd_ps(_mm256_loadu_ps(ny + j), Ly,
+												   _mm256_mul_ps(_mm256_loadu_ps(nz + j), Lz)));
+
+		d = _mm256_mul_ps(_mm256_max_ps(d, zero), _mm256_mul_ps(cone, _mm256_mul_ps(fall, fall)));
+
+		_mm256_storeu_ps(r + j, _mm256_fmadd_ps(R, d, _mm256_loadu_ps(r + j)));
+		_mm256_storeu_ps(g + j, _mm256_fmadd_ps(G, d, _mm256_loadu_ps(g + j)));
+		_mm256_storeu_ps(b + j, _mm256_fmadd_ps(B, d, _mm256_loadu_ps(b + j)));
+	}
+
+	return j;
+}
+#endif
+
+// Lights outermost, so each light's constants stay in registers while the
+// points stream past; the same light math as phong() in rasterizer.cpp.
+void light_list::diffuse(light_batch &B) const {
+	const int64_t N = B.size(), S = this->capacity;
+	const float eps = 1e-12f;
+
+	const float *nx = B.nx.data(), *ny = B.ny.data(), *nz = B.nz.data(),
+				*ex = B.ex.data(), *ey = B.ey.data(), *ez = B.ez.data();
+	float *r = B.r.data(), *g = B.g.data(), *b = B.b.data();
+
+	for (int64_t j = 0; j < N; j++)
+		r[j] = g[j] = b[j] = 0.0f;
+
+	for (int64_t k = 0; k < this->size(); k++) {
+		const float *F = this->soa.data() + k;
+		int64_t j = 0;
+
+#ifdef RASTER_X86
+		if (this->simd && raster_cpu_has_avx2())
+			j = diffuse_avx2(F, S, N, nx, ny, nz, ex, ey, ez, r, g, b);
+#endif
+
+		for (; j < N; j++) {
+			float W = F[RASTER_LIGHT_W * S],
+				  Lx = F[RASTER_LIGHT_X * S] + W * ex[j],
+				  Ly = F[RASTER_LIGHT_Y * S] + W * ey[j],
+				  Lz = F[RASTER_LIGHT_Z * S] + W * ez[j];
+
+			float d2 = Lx * Lx + Ly * Ly + Lz * Lz + eps,
+				  il = 1.0f / sqrtf(d2);
+
+			Lx *= il;
+			Ly *= il;
+			Lz *= il;
+
+			float cone = -(Lx * F[RASTER_LIGHT_AXIS_X * S] + Ly * F[RASTER_LIGHT_AXIS_Y * S] + Lz * F[RASTER_LIGHT_AXIS_Z * S]),
+				  fall = MAX(1.0f - d2 * F[RASTER_LIGHT_INV_RANGE2 * S], 0.0f);
+
+			cone = MIN(MAX(cone * F[RASTER_LIGHT_CONE_SCALE * S] + F[RASTER_LIGHT_CONE_BIAS * S], 0.0f), 1.0f);
+
+			float d = MAX(nx[j] * Lx + ny[j] * Ly + nz[j] * Lz, 0.0f) * cone * fall * fall;
+
+			r[j] += F[RASTER_LIGHT_R * S] * d;
+			g[j] += F[RASTER_LIGHT_G * S] * d;
+			b[j] += F[RASTER_LIGHT_B * S] * d;
+		}
+	}
+}
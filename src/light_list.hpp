@@ -0,0 +1,78 @@
+#ifndef LIGHT_LIST_HPP
+#define LIGHT_LIST_HPP
+
+#pragma once
+#include "color.hpp"
+#include "light.hpp"
+#include "rasterizer.hpp"
+#include "vec.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+// Points lit in bulk, one array per component. n is the unit surface
+// normal and e the vector from the point towards the eye.
+struct light_batch {
+	std::vector<float> nx, ny, nz, ex, ey, ez;
+	// Diffuse light received, summed over all lights.
+	std::vector<float> r, g, b;
+
+	void resize(int64_t N);
+
+	void set(int64_t idx,
+			 const vec3<double> &n,
+			 const vec3<double> &e);
+
+	int64_t size() const;
+};
+
+// Lights kept as a structure of arrays. Values derived from the lights and
+// the eye (unit directions, eye-relative positions, attenuation and cone
+// constants) are rebuilt by update only when either has changed, so the
+// shading passes read them once per light rather than once per face.
+class light_list {
+	private:
+		std::vector<light> lights;
+
+		// RASTER_LIGHT_FIELDS rows of capacity floats.
+		std::vector<float> soa;
+		int64_t capacity = 0;
+
+		bool dirty = true;
+		bool simd = true;
+		vec3<double> eye;
+	public:
+		light_list() {}
+
+		~light_list() {}
+
+		int64_t add(const light &l);
+
+		void set(int64_t idx, const light &l);
+
+		const light& get(int64_t idx) const;
+
+		void remove(int64_t idx);
+
+		void clear();
+
+		int64_t size() const;
+
+		// Rebuilds the derived values for an eye position.
+		void update(const vec3<double> &eye_position);
+
+		// Per-pixel lighting for a surface color. It points into the list
+		// and is valid until the next update; command_buffer copies it
+		// when recording.
+		raster_lighting lighting(const color &surface) const;
+
+		// Accumulates every light's diffuse term into B.r, B.g, B.b, one
+		// light at a time over all points.
+		void diffuse(light_batch &B) const;
+
+		// Uses AVX2 in diffuse when the CPU supports it and this is
+		// enabled, the scalar loop otherwise. Enabled by default.
+		void use_simd(bool enabled);
+};
+
+#endif
@@ -158,6 +158,8 @@ template <typename T> class mat4 {
 
         mat4(const mat4<T>& m2);
 
+        mat4<T>& operator=(const mat4<T>& m2);
+
 		~mat4() {
 			free(data);
 			data = NULL;
@@ -751,6 +753,14 @@ mat4<T>::mat4(const mat4<T>& m2) {
     }
 }
 
+template <typename T> 
+mat4<T>& mat4<T>::operator=(const mat4<T>& m2) {
+    for (int64_t k = 0; k < N; k++) 
+        this->data[k] = m2[k];
+
+    return *this;
+}
+
 template <typename T> 
 void mat4<T>::fill(T value) {
     for (int64_t k = 0; k < N; k++) 
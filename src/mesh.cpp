@@ -29,12 +29,133 @@ void mesh::assign_faces() {
 	}
 }
 
+void mesh::compute_bounds() const {
+	int64_t N = this->V.size();
+
+	linked_node<vec4<double>> *node = this->V.front();
+
+	double L[3] = { 0.0, 0.0, 0.0 }, H[3] = { 0.0, 0.0, 0.0 };
+
+	for (int64_t k = 0; k < N; k++) {
+		vec4<double> v = node->value();
+		double P[3] = { v.x() / v.w(), v.y() / v.w(), v.z() / v.w() };
+
+		for (int64_t j = 0; j < 3; j++) {
+			L[j] = (k == 0 ? P[j] : MIN(L[j], P[j]));
+			H[j] = (k == 0 ? P[j] : MAX(H[j], P[j]));
+		}
+
+		node = node->next();
+	}
+
+	double C[3] = { (L[0] + H[0]) / 2, (L[1] + H[1]) / 2, (L[2] + H[2]) / 2 },
+		   R = 0.0;
+
+	node = this->V.front();
+
+	for (int64_t k = 0; k < N; k++) {
+		vec4<double> v = node->value();
+		double dx = v.x() / v.w() - C[0],
+			   dy = v.y() / v.w() - C[1],
+			   dz = v.z() / v.w() - C[2];
+
+		R = MAX(R, dx * dx + dy * dy + dz * dz);
+
+		node = node->next();
+	}
+
+	this->lo = vec3<double>(L[0], L[1], L[2]);
+	this->hi = vec3<double>(H[0], H[1], H[2]);
+	this->center = vec3<double>(C[0], C[1], C[2]);
+	this->radius = sqrt(R);
+	this->dirty = false;
+}
+
+void mesh::compute_normals() const {
+	int64_t N = this->V.size();
+
+	std::vector<vec3<double>> P(N);
+	linked_node<vec4<double>> *node = this->V.front();
+
+	for (int64_t k = 0; k < N; k++) {
+		vec4<double> v = node->value();
+		P[k] = vec3<double>(v.x() / v.w(), v.y() / v.w(), v.z() / v.w());
+		node = node->next();
+	}
+
+	this->face_N.assign(this->M.size(), vec3<double>());
+	this->vertex_N.assign(N, vec3<double>());
+
+	linked_node<vec3<int64_t>> *map_node = this->M.front();
+
+	for (int64_t k = 0; k < this->M.size(); k++) {
+		vec3<int64_t> map = map_node->value();
+
+		// The cross product's length is twice the face area.
+		vec3<double> n = (P[map[1]] - P[map[0]]).cross(P[map[2]] - P[map[0]]);
+
+		for (int64_t j = 0; j < 3; j++)
+			this->vertex_N[map[j]] += n;
+
+		if (n.magnitude() > 0)
+			this->face_N[k] = n.normalize();
+
+		map_node = map_node->next();
+	}
+
+	for (int64_t k = 0; k < N; k++)
+		if (this->vertex_N[k].magnitude() > 0)
+			this->vertex_N[k] = this->vertex_N[k].normalize();
+
+	this->normals_dirty = false;
+}
+
 mesh::mesh() {}
 
 mesh::mesh(mesh &m) {
 	this->F = list(m.faces());
 	this->M = list(m.mappings());
 	this->V = list(m.vertices());
+	this->UV = m.uvs();
+	this->TM = m.uv_mappings();
+}
+
+// Parses one face corner, "v", "v/vt", "v//vn" or "v/vt/vn", into 0-based
+// vertex and texture coordinate indices (-1 when absent). Negative indices
+// count back from the last element read so far. False for a malformed
+// corner or an index outside what has been read.
+static bool parse_corner(const std::string &token,
+						 int64_t vertices,
+						 int64_t uvs,
+						 int64_t &vertex,
+						 int64_t &uv) {
+	const char *p = token.c_str();
+	char *end;
+
+	int64_t A = strtoll(p, &end, 10);
+
+	if (end == p)
+		return false;
+
+	vertex = (A < 0 ? A + vertices : A - 1);
+	uv = -1;
+
+	if (vertex < 0 || vertex >= vertices)
+		return false;
+
+	if (*end == '/' && end[1] != '/') {
+		p = end + 1;
+		int64_t T = strtoll(p, &end, 10);
+
+		if (end != p) {
+			uv = (T < 0 ? T + uvs : T - 1);
+
+			if (uv < 0 || uv >= uvs)
+				return false;
+		}
+	}
+
+	return true;
 }
 
 mesh::mesh(std::string fn) {
@@ -48,8 +169,11 @@ mesh::mesh(std::string fn) {
 	if (!in.is_open())
 		return;
 
+	bool textured = false;
+
 	while (std::getline(in, line)) {
 		std::istringstream stream(line);
+		type.clear();
 		stream >> type;
 
 		if (type == "v") {
@@ -57,28 +181,56 @@ mesh::mesh(std::string fn) {
 			stream >> x >> y >> z >> w;
 			vec4 v4 = vec4(x,y,z,w);
 			this->V.push_back(v4);
+		} else if (type == "vt") {
+			double u = 0.0, v = 0.0;
+			stream >> u >> v;
+			this->UV.push_back(vec2<double>(u, v));
 		} else if (type == "f") {
-			int64_t A, B, C, N = this->V.size();
-			stream >> A >> B >> C;
+			std::vector<int64_t> corners, coords;
+			std::string token;
+			int64_t vertex, uv;
+			bool valid = true;
+
+			while (valid && stream >> token && token[0] != '#') {
+				valid = parse_corner(token, this->V.size(), this->UV.size(), vertex, uv);
+				corners.push_back(vertex);
+				coords.push_back(uv);
+			}
 
-			if (A < 0) A = mod(A, N) + 1;
-			if (B < 0) B = mod(B, N) + 1;
-			if (C < 0) C = mod(C, N) + 1;
+			// Faces with a bad corner are dropped whole.
+			if (!valid)
+				continue;
 
-			vec3<int64_t> map = vec3<int64_t>(A-1, B-1, C-1);
-			this->M.push_back(map);
+			for (int64_t T : coords)
+				textured |= (T >= 0);
+
+			// Polygons are split into a fan around their first corner.
+			for (int64_t k = 1; k + 1 < (int64_t) corners.size(); k++) {
+				this->M.push_back(vec3<int64_t>(corners[0], corners[k], corners[k + 1]));
+				this->TM.push_back(vec3<int64_t>(coords[0], coords[k], coords[k + 1]));
+			}
 		}
 	}
 
 	in.close();
 
+	if (!textured)
+		this->TM.clear();
+
 	this->assign_faces();
+	this->compute_bounds();
 }
 
 mesh::~mesh() {
 }
 
 list<vec4<double>>& mesh::vertices() {
+	this->dirty = true;
+	this->normals_dirty = true;
+	return (this->V);
+}
+
+const list<vec4<double>>& mesh::vertices() const {
 	return (this->V);
 }
 
@@ -90,6 +242,18 @@ list<vec3<int64_t>>& mesh::mappings() {
 	return (this->M);
 }
 
+const std::vector<vec2<double>>& mesh::uvs() const {
+	return (this->UV);
+}
+
+const std::vector<vec3<int64_t>>& mesh::uv_mappings() const {
+	return (this->TM);
+}
+
+bool mesh::has_uvs() const {
+	return (!this->TM.empty() && (int64_t) this->TM.size() == this->M.size());
+}
+
 int64_t mesh::vertex_count() const {
 	return (this->V.size());
 }
@@ -97,3 +261,45 @@ int64_t mesh::vertex_count() const {
 int64_t mesh::face_count() const {
 	return (this->F.size());
 }
+
+vec3<double> mesh::aabb_min() const {
+	if (this->dirty)
+		this->compute_bounds();
+
+	return (this->lo);
+}
+
+vec3<double> mesh::aabb_max() const {
+	if (this->dirty)
+		this->compute_bounds();
+
+	return (this->hi);
+}
+
+vec3<double> mesh::bounding_center() const {
+	if (this->dirty)
+		this->compute_bounds();
+
+	return (this->center);
+}
+
+double mesh::bounding_radius() const {
+	if (this->dirty)
+		this->compute_bounds();
+
+	return (this->radius);
+}
+
+const std::vector<vec3<double>>& mesh::face_normals() const {
+	if (this->normals_dirty)
+		this->compute_normals();
+
+	return (this->face_N);
+}
+
+const std::vector<vec3<double>>& mesh::vertex_normals() const {
+	if (this->normals_dirty)
+		this->compute_normals();
+
+	return (this->vertex_N);
+}
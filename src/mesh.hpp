@@ -5,6 +5,7 @@
 #include <iostream>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 #include "triangle.hpp"
 #include "vec.hpp"
@@ -15,7 +16,23 @@ class mesh {
 		list<vec3<int64_t>> M;
 		list<vec4<double>> V;
 
+		// Texture coordinates and, per face in M order, their indices
+		// (-1 where a face gives none).
+		std::vector<vec2<double>> UV;
+		std::vector<vec3<int64_t>> TM;
+
+		// Bounds and normals are recomputed lazily once vertices() has
+		// handed out mutable access.
+		mutable bool dirty = true, normals_dirty = true;
+		mutable vec3<double> lo, hi, center;
+		mutable double radius = 0.0;
+		mutable std::vector<vec3<double>> face_N, vertex_N;
+
 		void assign_faces();
+
+		void compute_bounds() const;
+
+		void compute_normals() const;
 	public:
 		mesh();
 
@@ -25,15 +42,45 @@ class mesh {
 
 		~mesh();
 
+		// Marks the bounds stale; use the const overload to only read.
 		list<vec4<double>>& vertices();
 
+		const list<vec4<double>>& vertices() const;
+
 		list<triangle>& faces();
 
 		list<vec3<int64_t>>& mappings();
 
+		// Read from vt lines, as given (v = 0 at the bottom of the image).
+		const std::vector<vec2<double>>& uvs() const;
+
+		const std::vector<vec3<int64_t>>& uv_mappings() const;
+
+		// True when every face in mappings() has its texture coordinates.
+		bool has_uvs() const;
+
 		int64_t vertex_count() const;
 
 		int64_t face_count() const;
+
+		// Axis-aligned bounding box.
+		vec3<double> aabb_min() const;
+
+		vec3<double> aabb_max() const;
+
+		// Bounding sphere around the box center.
+		vec3<double> bounding_center() const;
+
+		double bounding_radius() const;
+
+		// Unit normals in mappings() order, following the indexed winding
+		// (counter-clockwise faces point outward). Unlike triangle::normal,
+		// which re-sorts the corners, the sign is consistent across faces.
+		const std::vector<vec3<double>>& face_normals() const;
+
+		// Unit vertex normals, averaged from the adjacent faces weighted by
+		// their area. Indexed like vertices().
+		const std::vector<vec3<double>>& vertex_normals() const;
 };
 
 #endif
@@ -0,0 +1,90 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#pragma once
+#include <chrono>
+#include <stdint.h>
+
+// Build with -DPROFILER_ENABLED=0 to compile every timer and counter out.
+// Counted expressions are still evaluated, only the counting is removed.
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+enum profile_stage {
+	STAGE_TRANSFORM,
+	STAGE_CULL,
+	STAGE_SHADING,
+	STAGE_RASTER,
+	STAGE_PRESENT,
+	STAGE_COUNT
+};
+
+enum profile_counter {
+	COUNT_SUBMITTED,
+	COUNT_CULLED,
+	COUNT_CLIPPED,
+	COUNT_RASTERIZED,
+	COUNT_PIXELS,
+	COUNT_STATE_CHANGES,
+	COUNTER_COUNT
+};
+
+struct frame_profile {
+	// Milliseconds.
+	double stages[STAGE_COUNT] = {};
+	int64_t counters[COUNTER_COUNT] = {};
+};
+
+// Accumulates the frame in progress; end_frame publishes it.
+class profiler {
+	private:
+		frame_profile current, last;
+	public:
+		profiler() {}
+
+		~profiler() {}
+
+		void add(profile_stage stage, double ms) {
+			current.stages[stage] += ms;
+		}
+
+		void count(profile_counter counter, int64_t n = 1) {
+			current.counters[counter] += n;
+		}
+
+		void end_frame() {
+			last = current;
+			current = frame_profile();
+		}
+
+		const frame_profile& last_frame() const {
+			return last;
+		}
+};
+
+// Adds the time until the end of the enclosing scope to a stage.
+class profile_scope {
+	private:
+		profiler &P;
+		profile_stage stage;
+		std::chrono::steady_clock::time_point start;
+	public:
+		profile_scope(profiler &p, profile_stage s) : P(p), stage(s), start(std::chrono::steady_clock::now()) {}
+
+		~profile_scope() {
+			P.add(stage, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+};
+
+#if PROFILER_ENABLED
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(P, S) profile_scope PROFILE_CONCAT(profile_scope_, __LINE__)(P, S)
+#define PROFILE_COUNT(P, C, N) (P).count(C, N)
+#else
+#define PROFILE_SCOPE(P, S)
+#define PROFILE_COUNT(P, C, N) ((void) (N))
+#endif
+
+#endif
@@ -0,0 +1,204 @@
+#include "rasterizer.hpp"
+
+#ifdef RASTER_X86
+#include <immintrin.h>
+
+#define RASTER_AVX2 __attribute__((target("avx2,fma")))
+
+// Clamps to [0, 255] and truncates, matching the scalar channel().
+RASTER_AVX2 static inline __m256i channel8(__m256 f) {
+	f = _mm256_min_ps(_mm256_max_ps(f, _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+	return _mm256_cvttps_epi32(f);
+}
+
+RASTER_AVX2 static inline __m256 inv_length(__m256 x, __m256 y, __m256 z) {
+	__m256 l = _mm256_fmadd_ps(x, x, _mm256_fmadd_ps(y, y, _mm256_fmadd_ps(z, z, _mm256_set1_ps(1e-12f))));
+	return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(l));
+}
+
+RASTER_AVX2 static inline __m256 dot(__m256 ax, __m256 ay, __m256 az,
+									 __m256 bx, __m256 by, __m256 bz) {
+	return _mm256_fmadd_ps(ax, bx, _mm256_fmadd_ps(ay, by, _mm256_mul_ps(az, bz)));
+}
+
+// Eight pixels of the scalar phong() in rasterizer.cpp.
+RASTER_AVX2 static inline __m256i phong8(const raster_lighting &P, const __m256 *v) {
+	const __m256 zero = _mm256_setzero_ps(),
+				 one = _mm256_set1_ps(1.0f);
+
+	__m256 in = inv_length(v[0], v[1], v[2]),
+		   ie = inv_length(v[3], v[4], v[5]);
+
+	__m256 Nx = _mm256_mul_ps(v[0], in),
+		   Ny = _mm256_mul_ps(v[1], in),
+		   Nz = _mm256_mul_ps(v[2], in),
+		   Ex = _mm256_mul_ps(v[3], ie),
+		   Ey = _mm256_mul_ps(v[4], ie),
+		   Ez = _mm256_mul_ps(v[5], ie);
+
+	__m256 diffuse[3] = { zero, zero, zero },
+		   specular[3] = { zero, zero, zero };
+
+	for (int64_t k = 0; k < P.count; k++) {
+		const float *F = P.soa + k;
+		const int64_t S = P.stride;
+
+		const __m256 W = _mm256_set1_ps(F[RASTER_LIGHT_W * S]);
+
+		__m256 Lx = _mm256_fmadd_ps(W, v[3], _mm256_set1_ps(F[RASTER_LIGHT_X * S])),
+			   Ly = _mm256_fmadd_ps(W, v[4], _mm256_set1_ps(F[RASTER_LIGHT_Y * S])),
+			   Lz = _mm256_fmadd_ps(W, v[5], _mm256_set1_ps(F[RASTER_LIGHT_Z * S]));
+
+		__m256 d2 = _mm256_fmadd_ps(Lx, Lx, _mm256_fmadd_ps(Ly, Ly, _mm256_fmadd_ps(Lz, Lz, _mm256_set1_ps(1e-12f)))),
+			   il = _mm256_div_ps(one, _mm256_sqrt_ps(d2));
+
+		Lx = _mm256_mul_ps(Lx, il);
+		Ly = _mm256_mul_ps(Ly, il);
+		Lz = _mm256_mul_ps(Lz, il);
+
+		__m256 Hx = _mm256_add_ps(Lx, Ex),
+			   Hy = _mm256_add_ps(Ly, Ey),
+			   Hz = _mm256_add_ps(Lz, Ez);
+
+		__m256 cone = dot(Lx, Ly, Lz,
+						  _mm256_set1_ps(-F[RASTER_LIGHT_AXIS_X * S]),
+						  _mm256_set1_ps(-F[RASTER_LIGHT_AXIS_Y * S]),
+						  _mm256_set1_ps(-F[RASTER_LIGHT_AXIS_Z * S]));
+
+		cone = _mm256_fmadd_ps(cone, _mm256_set1_ps(F[RASTER_LIGHT_CONE_SCALE * S]), _mm256_set1_ps(F[RASTER_LIGHT_CONE_BIAS * S]));
+		cone = _mm256_min_ps(_mm256_max_ps(cone, zero), one);
+
+		__m256 fall = _mm256_max_ps(_mm256_fnmadd_ps(d2, _mm256_set1_ps(F[RASTER_LIGHT_INV_RANGE2 * S]), one), zero),
+			   w = _mm256_mul_ps(cone, _mm256_mul_ps(fall, fall)),
+			   n = _mm256_set1_ps(F[RASTER_LIGHT_SHININESS * S]);
+
+		__m256 d = _mm256_max_ps(dot(Nx, Ny, Nz, Lx, Ly, Lz), zero),
+			   s = _mm256_max_ps(_mm256_mul_ps(dot(Nx, Ny, Nz, Hx, Hy, Hz), inv_length(Hx, Hy, Hz)), zero);
+
+		__m256 spec = _mm256_div_ps(_mm256_mul_ps(w, s), _mm256_add_ps(_mm256_fnmadd_ps(n, s, n), s));
+		spec = _mm256_and_ps(spec, _mm256_cmp_ps(d, zero, _CMP_GT_OQ));
+
+		d = _mm256_mul_ps(d, w);
+
+		for (int64_t c = 0; c < 3; c++) {
+			diffuse[c] = _mm256_fmadd_ps(_mm256_set1_ps(F[(RASTER_LIGHT_R + c) * S]), d, diffuse[c]);
+			specular[c] = _mm256_fmadd_ps(_mm256_set1_ps(F[(RASTER_LIGHT_SPECULAR_R + c) * S]), spec, specular[c]);
+		}
+	}
+
+	__m256i c = _mm256_set1_epi32(0xFF000000);
+
+	for (int64_t k = 0; k < 3; k++) {
+		__m256 f = _mm256_fmadd_ps(_mm256_set1_ps(P.diffuse[k]), diffuse[k],
+								   _mm256_mul_ps(_mm256_set1_ps(255.0f), specular[k]));
+
+		c = _mm256_or_si256(c, _mm256_slli_epi32(channel8(f), 8 * k));
+	}
+
+	return c;
+}
+
+RASTER_AVX2 int64_t raster_block_avx2(framebuffer *fb,
+									  const raster_triangle &t,
+									  int64_t x0, int64_t y0,
+									  int64_t x1, int64_t y1,
+									  int64_t edges) {
+	const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i ilane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+	// Lanes past x1 never load or store.
+	const __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(x1 - x0), ilane);
+
+	// Only edges crossing the block are tested. Their values inside the block
+	// stay close to zero, so 32-bit lanes cannot overflow; edges the block is
+	// entirely inside of may be far larger and are never loaded.
+	__m256i e[3], de[3];
+	int64_t tested = 0;
+
+	for (int64_t k = 0; k < 3; k++) {
+		if (!(edges & (1 << k)))
+			continue;
+
+		const raster_edge &E = t.e[k];
+		int64_t base = E.a * x0 + E.b * y0 + E.c;
+
+		e[tested] = _mm256_add_epi32(_mm256_set1_epi32(base),
+									 _mm256_mullo_epi32(_mm256_set1_epi32(E.a), ilane));
+		de[tested] = _mm256_set1_epi32(E.b);
+		++tested;
+	}
+
+	__m256 z = _mm256_fmadd_ps(_mm256_set1_ps(t.z.a), lane, _mm256_set1_ps(t.z.a * x0 + t.z.b * y0 + t.z.c));
+
+	__m256 v[RASTER_MAX_VARYINGS];
+
+	for (int64_t k = 0; k < t.varyings; k++)
+		v[k] = _mm256_fmadd_ps(_mm256_set1_ps(t.v[k].a), lane,
+							   _mm256_set1_ps(t.v[k].a * x0 + t.v[k].b * y0 + t.v[k].c));
+
+	__m256 w = _mm256_fmadd_ps(_mm256_set1_ps(t.w.a), lane, _mm256_set1_ps(t.w.a * x0 + t.w.b * y0 + t.w.c));
+
+	const __m256 dz = _mm256_set1_ps(t.z.b),
+				 dw = _mm256_set1_ps(t.w.b);
+
+	const __m256i flat = _mm256_set1_epi32(t.flat),
+				  alpha = _mm256_set1_epi32(0xFF000000);
+
+	int64_t written = 0;
+
+	for (int64_t y = y0; y < y1; y++) {
+		__m256i mask = valid;
+
+		// A lane is covered when no tested edge is negative.
+		for (int64_t k = 0; k < tested; k++)
+			mask = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), e[k]), mask);
+
+		if (!_mm256_testz_si256(mask, mask)) {
+			uint32_t *p = fb->row(y) + x0;
+			float *d = fb->depth_row(y) + x0;
+
+			if (t.depth_test) {
+				__m256 depth = _mm256_maskload_ps(d, mask);
+
+				mask = _mm256_and_si256(mask, _mm256_castps_si256(_mm256_cmp_ps(z, depth, _CMP_LT_OQ)));
+				_mm256_maskstore_ps(d, mask, z);
+			}
+
+			__m256i c = flat;
+			__m256 cv[RASTER_MAX_VARYINGS];
+			const __m256 *sv = v;
+
+			if (t.perspective) {
+				__m256 r = _mm256_div_ps(_mm256_set1_ps(1.0f), w);
+
+				for (int64_t k = 0; k < t.varyings; k++)
+					cv[k] = _mm256_mul_ps(v[k], r);
+
+				sv = cv;
+			}
+
+			if (t.shading == RASTER_COLOR)
+				c = _mm256_or_si256(_mm256_or_si256(channel8(sv[0]),
+													_mm256_slli_epi32(channel8(sv[1]), 8)),
+									_mm256_or_si256(_mm256_slli_epi32(channel8(sv[2]), 16), alpha));
+			else if (t.shading == RASTER_PHONG)
+				c = phong8(*t.lighting, sv);
+
+			_mm256_maskstore_epi32(reinterpret_cast<int*>(p), mask, c);
+			written += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(mask)));
+		}
+
+		for (int64_t k = 0; k < tested; k++)
+			e[k] = _mm256_add_epi32(e[k], de[k]);
+
+		z = _mm256_add_ps(z, dz);
+		w = _mm256_add_ps(w, dw);
+
+		for (int64_t k = 0; k < t.varyings; k++)
+			v[k] = _mm256_add_ps(v[k], _mm256_set1_ps(t.v[k].b));
+	}
+
+	return written;
+}
+
+#endif
@@ -0,0 +1,145 @@
+#include "rasterizer.hpp"
+
+#include <math.h>
+
+// Whether a circle of radius r around the centre of d reaches the buffer.
+// Callers return before converting anything to int64 when it does not,
+// which also turns away centres that are not finite.
+static inline bool overlaps(const raster_circle &d, double r,
+							int64_t W, int64_t H) {
+	return (isfinite(d.x) && isfinite(d.y) &&
+			d.x + r >= 0.0 && d.x - r <= W &&
+			d.y + r >= 0.0 && d.y - r <= H);
+}
+
+// Pixels [x0, x1] of a row whose centres are within h of cx. Both ends are
+// clamped into [-1, W] before the conversion to int64, so huge radii stay in
+// range and a span off the row stays empty.
+static inline void span(double cx, double h, int64_t W,
+						int64_t &x0, int64_t &x1) {
+	x0 = MIN(MAX(ceil(cx - h - 0.5), 0.0), (double) W);
+	x1 = MAX(MIN(floor(cx + h - 0.5), W - 1.0), -1.0);
+}
+
+// Rows whose centres are within r of cy, clamped the same way.
+static inline void rows(double cy, double r, int64_t H,
+						int64_t &y0, int64_t &y1) {
+	y0 = MIN(MAX(ceil(cy - r - 0.5), 0.0), (double) H);
+	y1 = MAX(MIN(floor(cy + r - 0.5), H - 1.0), -1.0);
+}
+
+static inline void fill(uint32_t *p, int64_t N, uint32_t c, bool blended) {
+	if (blended) {
+		for (int64_t k = 0; k < N; k++)
+			p[k] = blend_color(p[k], c);
+	} else {
+		for (int64_t k = 0; k < N; k++)
+			p[k] = c;
+	}
+}
+
+int64_t raster_disc(framebuffer *fb,
+					const raster_circle &d,
+					bool blended) {
+	const int64_t W = fb->width(), H = fb->height();
+
+	if (!(d.r > 0.0) || !overlaps(d, d.r, W, H))
+		return 0;
+
+	const double r2 = d.r * d.r;
+
+	int64_t y0, y1, written = 0;
+
+	rows(d.y, d.r, H, y0, y1);
+
+	for (int64_t y = y0; y <= y1; y++) {
+		double dy = y + 0.5 - d.y;
+
+		int64_t x0, x1;
+
+		span(d.x, sqrt(MAX(r2 - dy * dy, 0.0)), W, x0, x1);
+
+		if (x0 > x1)
+			continue;
+
+		fill(fb->row(y) + x0, x1 - x0 + 1, d.c, blended);
+		written += x1 - x0 + 1;
+	}
+
+	return written;
+}
+
+// Blends the edge pixels [x0, x1] of row p by coverage; the pixels written.
+static inline int64_t edge(uint32_t *p,
+						   int64_t x0, int64_t x1,
+						   const raster_circle &d,
+						   double dy2, double outer, double fade) {
+	int64_t written = 0;
+
+	for (int64_t x = x0; x <= x1; x++) {
+		double dx = x + 0.5 - d.x,
+			   coverage = outer - sqrt(dx * dx + dy2);
+
+		uint32_t src = cover_color(d.c, MIN(coverage, 1.0) * fade);
+
+		if (coverage > 0.0 && (src >> 24)) {
+			p[x] = blend_color(p[x], src);
+			++written;
+		}
+	}
+
+	return written;
+}
+
+int64_t raster_disc_smooth(framebuffer *fb,
+						   const raster_circle &d) {
+	const int64_t W = fb->width(), H = fb->height();
+
+	if (!(d.r > 0.0) || !overlaps(d, d.r + 0.5, W, H))
+		return 0;
+
+	// A pixel is covered by r + 0.5 - (distance of its centre), so it is
+	// touched inside the outer radius and fully covered inside the inner
+	// one. Circles thinner than a pixel also fade by their width.
+	const double outer = d.r + 0.5, inner = d.r - 0.5,
+				 fade = MIN(2.0 * d.r, 1.0);
+
+	const bool opaque = ((d.c >> 24) == 0xFF && fade == 1.0);
+
+	int64_t y0, y1, written = 0;
+
+	rows(d.y, outer, H, y0, y1);
+
+	for (int64_t y = y0; y <= y1; y++) {
+		double dy = y + 0.5 - d.y, dy2 = dy * dy;
+
+		int64_t a, b, i0 = 1, i1 = 0;
+
+		span(d.x, sqrt(MAX(outer * outer - dy2, 0.0)), W, a, b);
+
+		if (a > b)
+			continue;
+
+		if (inner > 0.0 && dy2 <= inner * inner)
+			span(d.x, sqrt(inner * inner - dy2), W, i0, i1);
+
+		// Without an interior the whole row is edge.
+		if (i0 > i1) {
+			i0 = b + 1;
+			i1 = b;
+		}
+
+		uint32_t *p = fb->row(y);
+
+		written += edge(p, a, i0 - 1, d, dy2, outer, fade);
+
+		if (i0 <= i1) {
+			fill(p + i0, i1 - i0 + 1, cover_color(d.c, fade), !opaque);
+			written += i1 - i0 + 1;
+		}
+
+		written += edge(p, i1 + 1, b, d, dy2, outer, fade);
+	}
+
+	return written;
+}
@@ -0,0 +1,302 @@
+#include "rasterizer.hpp"
+
+#include <math.h>
+#include <utility>
+
+// Floor division, also for negative numerators.
+static inline int64_t floor_div(int64_t n, int64_t d) {
+	return (n >= 0 ? n / d : -((-n + d - 1) / d));
+}
+
+static inline int64_t ceil_div(int64_t n, int64_t d) {
+	return -floor_div(-n, d);
+}
+
+// Packed color stepped along a line, with each channel in 16.16 fixed
+// point, so interpolation costs four adds per pixel.
+struct line_color {
+	int32_t c[4], d[4];
+
+	// Color at step start of a line reaching b after steps.
+	line_color(uint32_t a, uint32_t b, int64_t steps, int64_t start) {
+		for (int64_t k = 0; k < 4; k++) {
+			int32_t from = (a >> (8 * k)) & 0xFF,
+					to = (b >> (8 * k)) & 0xFF;
+
+			d[k] = (steps > 0 ? (to - from) * 65536 / steps : 0);
+			c[k] = from * 65536 + 32768 + static_cast<int32_t>(d[k] * start);
+		}
+	}
+
+	inline uint32_t get() const {
+		return static_cast<uint32_t>(c[0] >> 16) |
+			   static_cast<uint32_t>(c[1] >> 16) << 8 |
+			   static_cast<uint32_t>(c[2] >> 16) << 16 |
+			   static_cast<uint32_t>(c[3] >> 16) << 24;
+	}
+
+	inline void step() {
+		c[0] += d[0];
+		c[1] += d[1];
+		c[2] += d[2];
+		c[3] += d[3];
+	}
+};
+
+static uint32_t lerp_color(uint32_t a, uint32_t b, double t) {
+	uint32_t out = 0;
+
+	for (int64_t k = 0; k < 32; k += 8) {
+		double from = (a >> k) & 0xFF, to = (b >> k) & 0xFF;
+
+		out |= static_cast<uint32_t>(from + (to - from) * t + 0.5) << k;
+	}
+
+	return out;
+}
+
+// Liang-Barsky against [x0, x1] x [y0, y1], moving the end points and
+// their colors onto the boundary. False when nothing is left.
+static bool clip_segment(raster_segment &s,
+						 double x0, double y0,
+						 double x1, double y1) {
+	const double dx = s.x2 - s.x1, dy = s.y2 - s.y1;
+	const double p[4] = { -dx, dx, -dy, dy },
+				 q[4] = { s.x1 - x0, x1 - s.x1, s.y1 - y0, y1 - s.y1 };
+
+	double t0 = 0.0, t1 = 1.0;
+
+	for (int64_t k = 0; k < 4; k++) {
+		if (p[k] == 0.0) {
+			if (q[k] < 0.0)
+				return false;
+
+			continue;
+		}
+
+		double t = q[k] / p[k];
+
+		if (p[k] < 0.0)
+			t0 = MAX(t0, t);
+		else
+			t1 = MIN(t1, t);
+	}
+
+	if (t0 > t1)
+		return false;
+
+	raster_segment S = s;
+
+	s.x1 = S.x1 + dx * t0;
+	s.y1 = S.y1 + dy * t0;
+	s.x2 = S.x1 + dx * t1;
+	s.y2 = S.y1 + dy * t1;
+	s.c1 = lerp_color(S.c1, S.c2, t0);
+	s.c2 = lerp_color(S.c1, S.c2, t1);
+
+	return true;
+}
+
+// N pixels from p, stepping major every pixel and minor whenever the
+// error r reaches wrap.
+template <bool BLENDED, bool GRADIENT>
+static void bresenham(uint32_t *p,
+					  int64_t N,
+					  int64_t major, int64_t minor,
+					  int64_t r, int64_t dr, int64_t wrap,
+					  line_color c,
+					  uint32_t flat) {
+	for (int64_t k = 0; k < N; k++) {
+		uint32_t src = (GRADIENT ? c.get() : flat);
+
+		*p = (BLENDED ? blend_color(*p, src) : src);
+
+		if (GRADIENT)
+			c.step();
+
+		p += major;
+		r += dr;
+
+		if (r >= wrap) {
+			r -= wrap;
+			p += minor;
+		}
+	}
+}
+
+int64_t raster_line(framebuffer *fb,
+					const raster_segment &seg,
+					bool blended) {
+	const int64_t W = fb->width(), H = fb->height();
+
+	raster_segment s = seg;
+
+	// Far away end points are pulled in first, which keeps the integer
+	// set-up below in range at the cost of a slightly different slope.
+	if (MAX(fabs(s.x1), fabs(s.x2)) > RASTER_MAX_COORD ||
+		MAX(fabs(s.y1), fabs(s.y2)) > RASTER_MAX_COORD)
+		if (!clip_segment(s, -1.0, -1.0, W + 1.0, H + 1.0))
+			return 0;
+
+	int64_t x1 = floor(s.x1), y1 = floor(s.y1),
+			x2 = floor(s.x2), y2 = floor(s.y2);
+
+	bool steep = ABS((y2 - y1)) > ABS((x2 - x1));
+
+	// u is the major axis and v the minor one.
+	int64_t u1 = (steep ? y1 : x1), v1 = (steep ? x1 : y1),
+			du = (steep ? y2 - y1 : x2 - x1),
+			dv = (steep ? x2 - x1 : y2 - y1),
+			U = (steep ? H : W), V = (steep ? W : H);
+
+	int64_t su = (du < 0 ? -1 : 1), sv = (dv < 0 ? -1 : 1);
+
+	du = ABS(du);
+	dv = ABS(dv);
+
+	if (du == 0) {
+		if (!fb->contains(x1, y1))
+			return 0;
+
+		if (blended)
+			fb->blend(x1, y1, s.c1);
+		else
+			fb->set(x1, y1, s.c1);
+
+		return 1;
+	}
+
+	// Step i lands on u1 + su * i and v1 + sv * m(i), where
+	// m(i) = floor((2 * i * dv + du) / (2 * du)) rounds the ideal line.
+	// Both are monotonic, so the steps on screen form one range [i0, i1].
+	int64_t i0 = (su > 0 ? -u1 : u1 - (U - 1)),
+			i1 = (su > 0 ? U - 1 - u1 : u1);
+
+	int64_t m0 = (sv > 0 ? -v1 : v1 - (V - 1)),
+			m1 = (sv > 0 ? V - 1 - v1 : v1);
+
+	i0 = MAX(i0, 0);
+	i1 = MIN(i1, du);
+
+	if (dv > 0) {
+		i0 = MAX(i0, ceil_div(2 * du * m0 - du, 2 * dv));
+		i1 = MIN(i1, floor_div(2 * du * (m1 + 1) - du - 1, 2 * dv));
+	} else if (m0 > 0 || m1 < 0) {
+		return 0;
+	}
+
+	if (i0 > i1)
+		return 0;
+
+	int64_t n = 2 * i0 * dv + du,
+			u = u1 + su * i0,
+			v = v1 + sv * (n / (2 * du));
+
+	uint32_t *p = (steep ? fb->row(u) + v : fb->row(v) + u);
+
+	int64_t major = (steep ? su * W : su),
+			minor = (steep ? sv : sv * W),
+			N = i1 - i0 + 1,
+			r = n % (2 * du);
+
+	line_color c(s.c1, s.c2, du, i0);
+
+	if (s.c1 == s.c2) {
+		if (blended)
+			bresenham<true, false>(p, N, major, minor, r, 2 * dv, 2 * du, c, s.c1);
+		else
+			bresenham<false, false>(p, N, major, minor, r, 2 * dv, 2 * du, c, s.c1);
+	} else {
+		if (blended)
+			bresenham<true, true>(p, N, major, minor, r, 2 * dv, 2 * du, c, s.c1);
+		else
+			bresenham<false, true>(p, N, major, minor, r, 2 * dv, 2 * du, c, s.c1);
+	}
+
+	return N;
+}
+
+// Blends c over *p by coverage; 1 when anything was written.
+static inline int64_t cover(uint32_t *p, uint32_t c, double coverage) {
+	uint32_t src = cover_color(c, coverage);
+
+	if (!(src >> 24))
+		return 0;
+
+	*p = blend_color(*p, src);
+
+	return 1;
+}
+
+int64_t raster_line_smooth(framebuffer *fb,
+						   const raster_segment &seg) {
+	const int64_t W = fb->width(), H = fb->height();
+
+	// Pixel centres on integers from here on.
+	raster_segment s = seg;
+
+	s.x1 -= 0.5;
+	s.y1 -= 0.5;
+	s.x2 -= 0.5;
+	s.y2 -= 0.5;
+
+	// The margin keeps faded clipped ends off screen.
+	if (!clip_segment(s, -1.0, -1.0, W, H))
+		return 0;
+
+	bool steep = fabs(s.y2 - s.y1) > fabs(s.x2 - s.x1);
+
+	double u1 = (steep ? s.y1 : s.x1), v1 = (steep ? s.x1 : s.y1),
+		   u2 = (steep ? s.y2 : s.x2), v2 = (steep ? s.x2 : s.y2);
+
+	uint32_t c1 = s.c1, c2 = s.c2;
+
+	if (u2 < u1) {
+		std::swap(u1, u2);
+		std::swap(v1, v2);
+		std::swap(c1, c2);
+	}
+
+	const int64_t U = (steep ? H : W), V = (steep ? W : H),
+				  major = (steep ? W : 1), minor = (steep ? 1 : W);
+
+	double g = (u2 > u1 ? (v2 - v1) / (u2 - u1) : 0.0);
+
+	// End points cover their pixel by how far the line reaches into it.
+	int64_t a = floor(u1 + 0.5), b = floor(u2 + 0.5);
+
+	double gap1 = a + 0.5 - u1,
+		   gap2 = u2 - (b - 0.5);
+
+	if (a == b)
+		gap1 = gap2 = u2 - u1;
+
+	int64_t i0 = MAX(a, 0), i1 = MIN(b, U - 1);
+
+	line_color c(c1, c2, b - a, i0 - a);
+
+	double v = v1 + g * (i0 - u1);
+
+	uint32_t *pixels = fb->data();
+	int64_t written = 0;
+
+	for (int64_t i = i0; i <= i1; i++, v += g) {
+		double w = (i == a ? gap1 : i == b ? gap2 : 1.0);
+
+		int64_t j = floor(v);
+		double f = v - j;
+
+		uint32_t src = c.get();
+		int64_t o = i * major + j * minor;
+
+		if (j >= 0 && j < V)
+			written += cover(pixels + o, src, (1.0 - f) * w);
+
+		if (j + 1 >= 0 && j + 1 < V)
+			written += cover(pixels + o + minor, src, f * w);
+
+		c.step();
+	}
+
+	return written;
+}
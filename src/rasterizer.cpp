@@ -0,0 +1,445 @@
+#include "rasterizer.hpp"
+
+#include <math.h>
+#include <utility>
+
+static raster_plane plane(const raster_vertex &a,
+						  const raster_vertex &b,
+						  const raster_vertex &c,
+						  double fa, double fb, double fc,
+						  double inv_area) {
+	double dx = ((fb - fa) * (c.y - a.y) - (fc - fa) * (b.y - a.y)) * inv_area,
+		   dy = ((fc - fa) * (b.x - a.x) - (fb - fa) * (c.x - a.x)) * inv_area;
+
+	raster_plane P;
+
+	P.a = dx;
+	P.b = dy;
+	P.c = fa - dx * a.x - dy * a.y + 0.5 * (dx + dy);
+
+	return P;
+}
+
+// Floor division, also for negative numerators.
+static inline int64_t floor_div(int64_t n, int64_t d) {
+	return (n >= 0 ? n / d : -((-n + d - 1) / d));
+}
+
+static inline int64_t edge_at(const raster_edge &e, int64_t x, int64_t y) {
+	return e.a * x + e.b * y + e.c;
+}
+
+static inline uint32_t channel(float f) {
+	return (f <= 0.0f ? 0 : f >= 255.0f ? 255 : static_cast<uint32_t>(f));
+}
+
+// Diffuse plus Blinn-Phong specular summed over the lights, the same steps
+// as phong8 in raster_avx2.cpp. The specular power uses Schlick's
+// approximation s / (n - n * s + s), which needs no pow and vectorizes.
+static inline uint32_t phong(const raster_lighting &P, const float *v) {
+	const float eps = 1e-12f;
+
+	float n = 1.0f / sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + eps),
+		  e = 1.0f / sqrtf(v[3] * v[3] + v[4] * v[4] + v[5] * v[5] + eps);
+
+	float N[3] = { v[0] * n, v[1] * n, v[2] * n },
+		  E[3] = { v[3] * e, v[4] * e, v[5] * e };
+
+	float diffuse[3] = {}, specular[3] = {};
+
+	for (int64_t k = 0; k < P.count; k++) {
+		const float *F = P.soa + k;
+		const int64_t S = P.stride;
+
+		float L[3] = { F[RASTER_LIGHT_X * S] + F[RASTER_LIGHT_W * S] * v[3],
+					   F[RASTER_LIGHT_Y * S] + F[RASTER_LIGHT_W * S] * v[4],
+					   F[RASTER_LIGHT_Z * S] + F[RASTER_LIGHT_W * S] * v[5] };
+
+		float d2 = L[0] * L[0] + L[1] * L[1] + L[2] * L[2] + eps,
+			  l = 1.0f / sqrtf(d2);
+
+		L[0] *= l;
+		L[1] *= l;
+		L[2] *= l;
+
+		float H[3] = { L[0] + E[0], L[1] + E[1], L[2] + E[2] };
+		float h = 1.0f / sqrtf(H[0] * H[0] + H[1] * H[1] + H[2] * H[2] + eps);
+
+		float cone = -(L[0] * F[RASTER_LIGHT_AXIS_X * S] + L[1] * F[RASTER_LIGHT_AXIS_Y * S] + L[2] * F[RASTER_LIGHT_AXIS_Z * S]),
+			  fall = MAX(1.0f - d2 * F[RASTER_LIGHT_INV_RANGE2 * S], 0.0f);
+
+		cone = MIN(MAX(cone * F[RASTER_LIGHT_CONE_SCALE * S] + F[RASTER_LIGHT_CONE_BIAS * S], 0.0f), 1.0f);
+
+		float w = cone * fall * fall,
+			  d = MAX(N[0] * L[0] + N[1] * L[1] + N[2] * L[2], 0.0f),
+			  s = MAX((N[0] * H[0] + N[1] * H[1] + N[2] * H[2]) * h, 0.0f),
+			  shine = F[RASTER_LIGHT_SHININESS * S];
+
+		float spec = (d > 0.0f ? w * s / (shine - shine * s + s) : 0.0f);
+
+		d *= w;
+
+		for (int64_t c = 0; c < 3; c++) {
+			diffuse[c] += F[(RASTER_LIGHT_R + c) * S] * d;
+			specular[c] += F[(RASTER_LIGHT_SPECULAR_R + c) * S] * spec;
+		}
+	}
+
+	return channel(P.diffuse[0] * diffuse[0] + 255.0f * specular[0]) |
+		   channel(P.diffuse[1] * diffuse[1] + 255.0f * specular[1]) << 8 |
+		   channel(P.diffuse[2] * diffuse[2] + 255.0f * specular[2]) << 16 | 0xFF000000;
+}
+
+// Interpolated varying k at pixel (x, y), divided by 1 / w if needed.
+static inline float varying_at(const raster_triangle &t, int64_t k, int64_t x, int64_t y) {
+	float f = t.v[k].a * x + t.v[k].b * y + t.v[k].c;
+
+	return (t.perspective ? f / (t.w.a * x + t.w.b * y + t.w.c) : f);
+}
+
+// Mip level shared by the 2x2 quad holding pixel (x, y), from the UV
+// differences between its top-left pixel and its right and lower
+// neighbours. Covered or not, all four pixels of the quad agree.
+static inline float quad_lod(const raster_triangle &t, int64_t x, int64_t y) {
+	x &= ~(int64_t) 1;
+	y &= ~(int64_t) 1;
+
+	float u = varying_at(t, 0, x, y), v = varying_at(t, 1, x, y);
+
+	return t.tex->lod(varying_at(t, 0, x + 1, y) - u, varying_at(t, 1, x + 1, y) - v,
+					  varying_at(t, 0, x, y + 1) - u, varying_at(t, 1, x, y + 1) - v);
+}
+
+static inline uint32_t modulate(uint32_t a, uint32_t b) {
+	uint32_t r = 0;
+
+	for (int64_t s = 0; s < 32; s += 8)
+		r |= ((((a >> s) & 0xFF) * ((b >> s) & 0xFF) + 127) / 255) << s;
+
+	return r;
+}
+
+static inline uint32_t shade(const raster_triangle &t, const float *v, float lod = 0.0f) {
+	if (t.shading == RASTER_FLAT)
+		return t.flat;
+
+	if (t.shading == RASTER_PHONG)
+		return phong(*t.lighting, v);
+
+	if (t.shading == RASTER_TEXTURE)
+		return modulate(t.tex->sample(v[0], v[1], lod, t.filter), t.flat);
+
+	return channel(v[0]) | channel(v[1]) << 8 | channel(v[2]) << 16 | 0xFF000000;
+}
+
+bool raster_cpu_has_avx2() {
+#ifdef RASTER_X86
+	static const bool supported = __builtin_cpu_supports("avx2") && 
+								  __builtin_cpu_supports("fma");
+	return supported;
+#else
+	return false;
+#endif
+}
+
+rasterizer::rasterizer(framebuffer *fb) : fb(fb) {
+	this->use_simd(true);
+}
+
+void rasterizer::use_simd(bool enabled) {
+	this->kernel = &raster_block_scalar;
+	this->simd = false;
+
+#ifdef RASTER_X86
+	if (enabled && raster_cpu_has_avx2()) {
+		this->kernel = &raster_block_avx2;
+		this->simd = true;
+	}
+#endif
+}
+
+bool rasterizer::simd_enabled() const {
+	return this->simd;
+}
+
+bool rasterizer::setup(raster_triangle &t,
+					   const raster_vertex &v1,
+					   const raster_vertex &v2,
+					   const raster_vertex &v3,
+					   int64_t varyings) const {
+	const raster_vertex *V[3] = { &v1, &v2, &v3 };
+	int64_t X[3], Y[3];
+
+	for (int64_t k = 0; k < 3; k++) {
+		if (!(ABS(V[k]->x) < RASTER_MAX_COORD && ABS(V[k]->y) < RASTER_MAX_COORD))
+			return false;
+
+		X[k] = llround(V[k]->x * RASTER_SUBPIXEL);
+		Y[k] = llround(V[k]->y * RASTER_SUBPIXEL);
+	}
+
+	int64_t area = (X[1] - X[0]) * (Y[2] - Y[0]) - (X[2] - X[0]) * (Y[1] - Y[0]);
+
+	if (area == 0)
+		return false;
+
+	// Edge functions are built for positive area.
+	if (area < 0) {
+		std::swap(V[1], V[2]);
+		std::swap(X[1], X[2]);
+		std::swap(Y[1], Y[2]);
+		area = -area;
+	}
+
+	const int64_t half = RASTER_SUBPIXEL / 2;
+
+	// Pixels whose sample centres (16x + 8, 16y + 8) lie in the bounding box.
+	int64_t min_x = MIN(MIN(X[0], X[1]), X[2]), max_x = MAX(MAX(X[0], X[1]), X[2]),
+			min_y = MIN(MIN(Y[0], Y[1]), Y[2]), max_y = MAX(MAX(Y[0], Y[1]), Y[2]);
+
+	t.x0 = MAX(-floor_div(half - min_x, RASTER_SUBPIXEL), (int64_t) 0);
+	t.y0 = MAX(-floor_div(half - min_y, RASTER_SUBPIXEL), (int64_t) 0);
+	t.x1 = MIN(floor_div(max_x - half, RASTER_SUBPIXEL) + 1, fb->width());
+	t.y1 = MIN(floor_div(max_y - half, RASTER_SUBPIXEL) + 1, fb->height());
+
+	if (t.x0 >= t.x1 || t.y0 >= t.y1)
+		return false;
+
+	t.micro = (t.x1 - t.x0 <= RASTER_MICRO_SIZE && t.y1 - t.y0 <= RASTER_MICRO_SIZE);
+
+	for (int64_t k = 0; k < 3; k++) {
+		int64_t p = k, q = (k + 1) % 3;
+
+		int64_t A = Y[p] - Y[q],
+				B = X[q] - X[p];
+
+		// Top edges (horizontal, interior below) and left edges keep pixels
+		// lying exactly on them; every other edge gives them up.
+		bool top_left = (A > 0 || (A == 0 && B > 0));
+
+		t.e[k].a = A * RASTER_SUBPIXEL;
+		t.e[k].b = B * RASTER_SUBPIXEL;
+		t.e[k].c = A * (half - X[p]) + B * (half - Y[p]) - (top_left ? 0 : 1);
+	}
+
+	// Attribute planes use the snapped positions, so they agree with coverage.
+	raster_vertex a = *V[0], b = *V[1], c = *V[2];
+
+	a.x = X[0] / (double) RASTER_SUBPIXEL;
+	a.y = Y[0] / (double) RASTER_SUBPIXEL;
+	b.x = X[1] / (double) RASTER_SUBPIXEL;
+	b.y = Y[1] / (double) RASTER_SUBPIXEL;
+	c.x = X[2] / (double) RASTER_SUBPIXEL;
+	c.y = Y[2] / (double) RASTER_SUBPIXEL;
+
+	double inv_area = (RASTER_SUBPIXEL * RASTER_SUBPIXEL) / (double) area;
+
+	t.z = plane(a, b, c, a.z, b.z, c.z, inv_area);
+
+	t.perspective = (varyings > 0 && !(a.inv_w == b.inv_w && a.inv_w == c.inv_w));
+
+	if (t.perspective) {
+		t.w = plane(a, b, c, a.inv_w, b.inv_w, c.inv_w, inv_area);
+
+		for (int64_t k = 0; k < varyings; k++)
+			t.v[k] = plane(a, b, c, a.v[k] * a.inv_w, b.v[k] * b.inv_w, c.v[k] * c.inv_w, inv_area);
+	} else {
+		for (int64_t k = 0; k < varyings; k++)
+			t.v[k] = plane(a, b, c, a.v[k], b.v[k], c.v[k], inv_area);
+	}
+
+	t.varyings = varyings;
+
+	return true;
+}
+
+int64_t rasterizer::draw(const raster_triangle &t) {
+	return this->draw(t, 0, 0, fb->width(), fb->height());
+}
+
+int64_t rasterizer::draw(const raster_triangle &t,
+						 int64_t x0, int64_t y0,
+						 int64_t x1, int64_t y1) {
+	const int64_t S = RASTER_BLOCK_SIZE;
+
+	if (t.micro)
+		return raster_micro(fb, &t, 1, x0, y0, x1, y1);
+
+	x0 = MAX(x0, t.x0);
+	y0 = MAX(y0, t.y0);
+	x1 = MIN(x1, t.x1);
+	y1 = MIN(y1, t.y1);
+
+	raster_block_kernel K = (t.blend || t.shading == RASTER_TEXTURE ? &raster_block_scalar : this->kernel);
+	int64_t written = 0;
+
+	for (int64_t by = y0 & ~(S - 1); by < y1; by += S) {
+		for (int64_t bx = x0 & ~(S - 1); bx < x1; bx += S) {
+			int64_t edges = 0;
+			bool outside = false;
+
+			// Trivial reject/accept using the block corner that minimises
+			// and maximises each edge function.
+			for (int64_t k = 0; k < 3 && !outside; k++) {
+				const raster_edge &e = t.e[k];
+
+				int64_t base = edge_at(e, bx, by),
+						lo = base + (MIN(e.a, (int64_t) 0) + MIN(e.b, (int64_t) 0)) * (S - 1),
+						hi = base + (MAX(e.a, (int64_t) 0) + MAX(e.b, (int64_t) 0)) * (S - 1);
+
+				if (hi < 0)
+					outside = true;
+				else if (lo < 0)
+					edges |= (1 << k);
+			}
+
+			if (outside)
+				continue;
+
+			written += K(fb, t,
+						 MAX(bx, x0), MAX(by, y0),
+						 MIN(bx + S, x1), MIN(by + S, y1),
+						 edges);
+		}
+	}
+
+	return written;
+}
+
+int64_t rasterizer::draw_micro(const raster_triangle *T, int64_t N) {
+	return raster_micro(fb, T, N, 0, 0, fb->width(), fb->height());
+}
+
+int64_t raster_micro(framebuffer *fb,
+					 const raster_triangle *T,
+					 int64_t N,
+					 int64_t x0, int64_t y0,
+					 int64_t x1, int64_t y1) {
+	float v[RASTER_MAX_VARYINGS];
+	int64_t written = 0;
+
+	for (int64_t n = 0; n < N; n++) {
+		const raster_triangle &t = T[n];
+
+		int64_t ys = MAX(y0, t.y0), ye = MIN(y1, t.y1),
+				xs = MAX(x0, t.x0), xe = MIN(x1, t.x1);
+
+		for (int64_t y = ys; y < ye; y++) {
+			uint32_t *p = fb->row(y);
+			float *d = fb->depth_row(y);
+
+			for (int64_t x = xs; x < xe; x++) {
+				if (edge_at(t.e[0], x, y) < 0 ||
+					edge_at(t.e[1], x, y) < 0 ||
+					edge_at(t.e[2], x, y) < 0)
+					continue;
+
+				float z = t.z.a * x + t.z.b * y + t.z.c;
+
+				if (t.depth_test) {
+					if (z >= d[x])
+						continue;
+
+					if (!t.blend)
+						d[x] = z;
+				}
+
+				float r = (t.perspective ? 1.0f / (t.w.a * x + t.w.b * y + t.w.c) : 1.0f);
+
+				for (int64_t k = 0; k < t.varyings; k++)
+					v[k] = (t.v[k].a * x + t.v[k].b * y + t.v[k].c) * r;
+
+				float lod = (t.shading == RASTER_TEXTURE ? quad_lod(t, x, y) : 0.0f);
+				uint32_t c = shade(t, v, lod);
+
+				p[x] = (t.blend ? blend_color(p[x], c) : c);
+				++written;
+			}
+		}
+	}
+
+	return written;
+}
+
+int64_t raster_block_scalar(framebuffer *fb,
+							const raster_triangle &t,
+							int64_t x0, int64_t y0,
+							int64_t x1, int64_t y1,
+							int64_t edges) {
+	const raster_edge &E0 = t.e[0], &E1 = t.e[1], &E2 = t.e[2];
+	const bool full = (edges == 0);
+	int64_t written = 0;
+
+	int64_t e0 = edge_at(E0, x0, y0),
+			e1 = edge_at(E1, x0, y0),
+			e2 = edge_at(E2, x0, y0);
+
+	float z = t.z.a * x0 + t.z.b * y0 + t.z.c,
+		  w = t.w.a * x0 + t.w.b * y0 + t.w.c;
+
+	float v[RASTER_MAX_VARYINGS], pv[RASTER_MAX_VARYINGS], cv[RASTER_MAX_VARYINGS];
+
+	for (int64_t k = 0; k < t.varyings; k++)
+		v[k] = t.v[k].a * x0 + t.v[k].b * y0 + t.v[k].c;
+
+	for (int64_t y = y0; y < y1; y++) {
+		uint32_t *p = fb->row(y);
+		float *d = fb->depth_row(y);
+
+		int64_t f0 = e0, f1 = e1, f2 = e2;
+		float pz = z, pw = w, lod = 0.0f;
+		int64_t quad = INT64_MIN;
+
+		for (int64_t k = 0; k < t.varyings; k++)
+			pv[k] = v[k];
+
+		for (int64_t x = x0; x < x1; x++) {
+			if ((full || (f0 >= 0 && f1 >= 0 && f2 >= 0)) &&
+				(!t.depth_test || pz < d[x])) {
+				if (t.depth_test && !t.blend)
+					d[x] = pz;
+
+				const float *sv = pv;
+
+				if (t.perspective) {
+					float r = 1.0f / pw;
+
+					for (int64_t k = 0; k < t.varyings; k++)
+						cv[k] = pv[k] * r;
+
+					sv = cv;
+				}
+
+				if (t.shading == RASTER_TEXTURE && (x >> 1) != quad) {
+					lod = quad_lod(t, x, y);
+					quad = x >> 1;
+				}
+
+				uint32_t c = shade(t, sv, lod);
+
+				p[x] = (t.blend ? blend_color(p[x], c) : c);
+				++written;
+			}
+
+			f0 += E0.a;
+			f1 += E1.a;
+			f2 += E2.a;
+			pz += t.z.a;
+			pw += t.w.a;
+
+			for (int64_t k = 0; k < t.varyings; k++)
+				pv[k] += t.v[k].a;
+		}
+
+		e0 += E0.b;
+		e1 += E1.b;
+		e2 += E2.b;
+		z += t.z.b;
+		w += t.w.b;
+
+		for (int64_t k = 0; k < t.varyings; k++)
+			v[k] += t.v[k].b;
+	}
+
+	return written;
+}
@@ -0,0 +1,254 @@
+#ifndef RASTERIZER_HPP
+#define RASTERIZER_HPP
+
+#pragma once
+#include "framebuffer.hpp"
+#include "texture.hpp"
+
+#include <stdint.h>
+
+#define RASTER_BLOCK_SIZE 8
+// Triangles whose candidate pixels fit in this square skip block traversal.
+#define RASTER_MICRO_SIZE 2
+#define RASTER_MAX_VARYINGS 6
+
+// Vertices are snapped to 28.4 fixed point before edge setup.
+#define RASTER_SUBPIXEL_BITS 4
+#define RASTER_SUBPIXEL (1 << RASTER_SUBPIXEL_BITS)
+
+// Triangles reaching further than this (in pixels) are rejected, which keeps
+// edge values inside a block within 32 bits.
+#define RASTER_MAX_COORD (1 << 17)
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RASTER_X86 1
+#endif
+
+// Screen-space vertex: pixel coordinates, NDC depth, 1 / w of the clip
+// position and the attributes (varyings) interpolated across the triangle.
+struct raster_vertex {
+	double x = 0.0, y = 0.0, z = 0.0, inv_w = 1.0;
+	float v[RASTER_MAX_VARYINGS] = {};
+};
+
+enum raster_shading {
+	RASTER_FLAT,
+	// Varyings 0..2 hold R, G, B in [0, 255].
+	RASTER_COLOR,
+	// Varyings 0..2 hold the surface normal and 3..5 the vector towards the
+	// eye, both unnormalized. Lit per pixel from the triangle's lighting.
+	RASTER_PHONG,
+	// Varyings 0..1 hold texture coordinates. The texel is modulated by
+	// the flat color, and mip levels come from the UV derivatives across
+	// each 2x2 pixel quad.
+	RASTER_TEXTURE
+};
+
+inline int64_t raster_varyings(raster_shading shading) {
+	switch (shading) {
+		case RASTER_COLOR: return 3;
+		case RASTER_PHONG: return 6;
+		case RASTER_TEXTURE: return 2;
+		default: return 0;
+	}
+}
+
+// Per-light values for RASTER_PHONG. For a pixel with eye vector E, the
+// vector towards the light is (X, Y, Z) + W * E, so directional (W = 0),
+// point and spot lights share one branch-free path. The spot factor is
+// clamp(cos * CONE_SCALE + CONE_BIAS, 0, 1), with cos the angle to AXIS
+// (1 for lights without a cone). Attenuation is (1 - d^2 * INV_RANGE2)^2.
+// Colors are in [0, 1].
+enum raster_light_field {
+	RASTER_LIGHT_X,
+	RASTER_LIGHT_Y,
+	RASTER_LIGHT_Z,
+	RASTER_LIGHT_W,
+	RASTER_LIGHT_AXIS_X,
+	RASTER_LIGHT_AXIS_Y,
+	RASTER_LIGHT_AXIS_Z,
+	RASTER_LIGHT_CONE_SCALE,
+	RASTER_LIGHT_CONE_BIAS,
+	RASTER_LIGHT_INV_RANGE2,
+	RASTER_LIGHT_R,
+	RASTER_LIGHT_G,
+	RASTER_LIGHT_B,
+	RASTER_LIGHT_SPECULAR_R,
+	RASTER_LIGHT_SPECULAR_G,
+	RASTER_LIGHT_SPECULAR_B,
+	RASTER_LIGHT_SHININESS,
+	RASTER_LIGHT_FIELDS
+};
+
+// Lights as a structure of arrays: field f of light k is
+// soa[f * stride + k]. diffuse is the surface color in [0, 255].
+struct raster_lighting {
+	int64_t count = 0, stride = 0;
+	const float *soa = nullptr;
+	float diffuse[3] = {};
+};
+
+// f(x, y) = a * x + b * y + c, with (x, y) the integer pixel index.
+// Pixel centres are folded into c during setup.
+struct raster_plane {
+	float a, b, c;
+};
+
+// Integer edge function e(x, y) = a * x + b * y + c at the pixel index, in
+// 24.8 fixed point. Sample centres and the top-left bias are folded into c,
+// so a pixel is covered exactly when all three edges are >= 0.
+struct raster_edge {
+	int64_t a, b, c;
+};
+
+// Triangle after setup.
+struct raster_triangle {
+	int64_t x0, y0, x1, y1;
+
+	raster_edge e[3];
+	raster_plane z;
+	raster_plane v[RASTER_MAX_VARYINGS];
+
+	// With perspective set, the varying planes hold v / w and are divided
+	// per pixel by the 1 / w plane. Left unset when all three vertices
+	// share w, where screen-space interpolation is already exact.
+	raster_plane w = { 0.0f, 0.0f, 1.0f };
+	bool perspective = false;
+
+	int64_t varyings = 0;
+	raster_shading shading = RASTER_FLAT;
+	uint32_t flat = 0xFF000000;
+	bool depth_test = true;
+
+	// Alpha blends over the framebuffer; depth is tested but not written.
+	// Blended and textured triangles always take the scalar kernel.
+	bool blend = false;
+
+	// Set by setup when the bounding box is at most RASTER_MICRO_SIZE pixels
+	// on each side.
+	bool micro = false;
+
+	// Read for RASTER_PHONG and RASTER_TEXTURE when the triangle is drawn,
+	// so they have to stay valid until then.
+	const raster_lighting *lighting = nullptr;
+	const texture *tex = nullptr;
+	texture_filter filter = FILTER_TRILINEAR;
+};
+
+// Fills the pixels of [x0, x1) x [y0, y1) (at most one block) covered by t.
+// Bit k of edges is set when edge k crosses the block and has to be tested
+// per pixel; 0 means the block is inside the triangle. Kernels return the
+// number of pixels written.
+typedef int64_t (*raster_block_kernel)(framebuffer *fb,
+									   const raster_triangle &t,
+									   int64_t x0, int64_t y0,
+									   int64_t x1, int64_t y1,
+									   int64_t edges);
+
+int64_t raster_block_scalar(framebuffer *fb,
+							const raster_triangle &t,
+							int64_t x0, int64_t y0,
+							int64_t x1, int64_t y1,
+							int64_t edges);
+
+#ifdef RASTER_X86
+// One block row per iteration, eight pixels in AVX2 lanes (raster_avx2.cpp).
+int64_t raster_block_avx2(framebuffer *fb,
+						  const raster_triangle &t,
+						  int64_t x0, int64_t y0,
+						  int64_t x1, int64_t y1,
+						  int64_t edges);
+#endif
+
+// Tests the (at most four) candidate sample centres of each micro
+// triangle directly, clipped to [x0, x1) x [y0, y1).
+int64_t raster_micro(framebuffer *fb,
+					 const raster_triangle *T,
+					 int64_t N,
+					 int64_t x0, int64_t y0,
+					 int64_t x1, int64_t y1);
+
+// Checks CPUID for AVX2 and FMA.
+bool raster_cpu_has_avx2();
+
+// Screen-space line segment in pixel coordinates, colored from c1 at the
+// first end point to c2 at the second.
+struct raster_segment {
+	double x1 = 0.0, y1 = 0.0, x2 = 0.0, y2 = 0.0;
+	uint32_t c1 = 0, c2 = 0;
+};
+
+// Bresenham between the pixels holding the end points (raster_line.cpp).
+// The walk starts and stops at the buffer edges, computed in integer steps,
+// so clipped lines keep their pixels and off-screen segments cost nothing.
+// Both line calls return the number of pixels written.
+int64_t raster_line(framebuffer *fb,
+					const raster_segment &s,
+					bool blended);
+
+// Xiaolin Wu anti-aliased line. Each step along the major axis blends the
+// two pixels straddling the line, weighted by their coverage.
+int64_t raster_line_smooth(framebuffer *fb,
+						   const raster_segment &s);
+
+// Screen-space filled circle: centre in pixel coordinates, radius in pixels.
+struct raster_circle {
+	double x = 0.0, y = 0.0, r = 0.0;
+	uint32_t c = 0;
+};
+
+// Pixels whose centres lie inside the circle, written as exactly one span
+// per row (raster_disc.cpp). Both disc calls return the pixels written.
+int64_t raster_disc(framebuffer *fb,
+					const raster_circle &d,
+					bool blended);
+
+// Anti-aliased disc. Each row is a solid span where the circle covers the
+// whole pixel, between edge pixels blended by the distance of their centre
+// to the circle.
+int64_t raster_disc_smooth(framebuffer *fb,
+						   const raster_circle &d);
+
+// Half-space rasterizer that walks the triangle's bounding box in
+// RASTER_BLOCK_SIZE square blocks. Blocks outside an edge are skipped,
+// blocks inside all three edges are filled without edge tests, and only
+// blocks straddling an edge are tested per pixel. Edges use a strict
+// top-left rule, so pixels on an edge shared by two triangles are drawn
+// by exactly one of them.
+class rasterizer {
+	private:
+		framebuffer *fb;
+		raster_block_kernel kernel;
+		bool simd = false;
+	public:
+		rasterizer(framebuffer *fb);
+
+		~rasterizer() {}
+
+		// Uses the widest kernel the CPU supports when enabled, the scalar
+		// kernel otherwise. Enabled by default.
+		void use_simd(bool enabled);
+
+		bool simd_enabled() const;
+
+		// Builds edge and attribute planes. Returns false for degenerate or
+		// fully off-screen triangles.
+		bool setup(raster_triangle &t,
+				   const raster_vertex &v1,
+				   const raster_vertex &v2,
+				   const raster_vertex &v3,
+				   int64_t varyings = 0) const;
+
+		// The draw calls return the number of pixels written.
+		int64_t draw(const raster_triangle &t);
+
+		// Only touches pixels in [x0, x1) x [y0, y1).
+		int64_t draw(const raster_triangle &t,
+					 int64_t x0, int64_t y0,
+					 int64_t x1, int64_t y1);
+
+		// Draws N triangles that were all classified as micro by setup.
+		int64_t draw_micro(const raster_triangle *T, int64_t N);
+};
+
+#endif
@@ -0,0 +1,117 @@
+#include "render_target.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+sdl_target::sdl_target(int64_t W, int64_t H) {
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        SDL_Log("Failed to initialize SDL Window: %s\n", SDL_GetError());
+        return;
+    }
+
+    this->w = SDL_CreateWindow("balls",
+   							   SDL_WINDOWPOS_CENTERED,
+							   SDL_WINDOWPOS_CENTERED,
+							   W,
+							   H,
+							   SDL_WINDOW_SHOWN);
+
+    if (!this->w) {
+        SDL_Log("Failed to initialize SDL Window: %s\n", SDL_GetError());
+        return;
+    }
+
+    this->r = SDL_CreateRenderer(this->w, -1, SDL_RENDERER_ACCELERATED);
+
+    if (!this->r) {
+        SDL_Log("Failed to initialize SDL Window: %s\n", SDL_GetError());
+        return;
+    }
+
+	this->tex = SDL_CreateTexture(this->r,
+								  SDL_PIXELFORMAT_ABGR8888,
+								  SDL_TEXTUREACCESS_STREAMING,
+								  W,
+								  H);
+
+	if (!this->tex) {
+        SDL_Log("Failed to initialize SDL Window: %s\n", SDL_GetError());
+        return;
+	}
+
+    this->init = true;
+}
+
+sdl_target::~sdl_target() {
+	if (this->tex)
+		SDL_DestroyTexture(this->tex);
+
+    if (this->r) 
+        SDL_DestroyRenderer(this->r);
+
+    if (this->w) 
+        SDL_DestroyWindow(this->w);
+
+    SDL_Quit();
+}
+
+bool sdl_target::ready() const {
+	return this->init;
+}
+
+void sdl_target::present(const framebuffer &fb) {
+	if (!this->init)
+		return;
+
+	void *dst;
+	int pitch;
+
+	// Single upload of the whole frame, regardless of how much was drawn.
+	if (SDL_LockTexture(this->tex, NULL, &dst, &pitch) == 0) {
+		int64_t row_bytes = fb.pitch();
+
+		for (int64_t y = 0; y < fb.height(); y++) 
+			memcpy(static_cast<uint8_t*>(dst) + y * pitch, fb.row(y), row_bytes);
+
+		SDL_UnlockTexture(this->tex);
+	} else {
+		SDL_UpdateTexture(this->tex, NULL, fb.data(), fb.pitch());
+	}
+
+	SDL_RenderCopy(this->r, this->tex, NULL, NULL);
+	SDL_RenderPresent(this->r);
+}
+
+bool sdl_target::poll(SDL_Event &event) {
+	return SDL_PollEvent(&event);
+}
+
+bool sdl_target::vsync(bool enabled) {
+	return (this->init && SDL_RenderSetVSync(this->r, enabled) == 0);
+}
+
+headless_target::headless_target(std::string P, image_format F) : pattern(P), format(F) {}
+
+bool headless_target::ready() const {
+	return true;
+}
+
+void headless_target::present(const framebuffer &fb) {
+	if (!this->pattern.empty()) {
+		char fn[4096];
+		snprintf(fn, sizeof(fn), this->pattern.c_str(), (long) this->frames);
+
+		if (!write_image(fb, fn, this->format))
+			fprintf(stderr, "Failed to write frame %s\n", fn);
+	}
+
+	++this->frames;
+}
+
+bool headless_target::poll(SDL_Event &) {
+	return false;
+}
+
+int64_t headless_target::frame_count() const {
+	return this->frames;
+}
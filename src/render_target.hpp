@@ -0,0 +1,78 @@
+#ifndef RENDER_TARGET_HPP
+#define RENDER_TARGET_HPP
+
+#pragma once
+#include "framebuffer.hpp"
+#include "image.hpp"
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <string>
+
+// Where a window's finished frames go. Drawing always happens in the
+// window's framebuffer; a target only receives it on present.
+class render_target {
+	public:
+		virtual ~render_target() {}
+
+		// False when the target failed to open.
+		virtual bool ready() const = 0;
+
+		virtual void present(const framebuffer &fb) = 0;
+
+		// Next pending input event, if any.
+		virtual bool poll(SDL_Event &event) = 0;
+
+		// Whether present now blocks on the display refresh.
+		virtual bool vsync(bool) { return false; }
+};
+
+// An SDL window with a streaming texture the frame is uploaded into.
+// Presenting never sleeps; pacing is left to the window's frame_pacer.
+class sdl_target : public render_target {
+	private:
+		SDL_Window *w = nullptr;
+		SDL_Renderer *r = nullptr;
+		SDL_Texture *tex = nullptr;
+
+		bool init = false;
+	public:
+		sdl_target(int64_t W, int64_t H);
+
+		sdl_target(const sdl_target &t) = delete;
+
+		~sdl_target();
+
+		bool ready() const;
+
+		void present(const framebuffer &fb);
+
+		bool poll(SDL_Event &event);
+
+		bool vsync(bool enabled);
+};
+
+// No SDL video at all. Frames stay in the framebuffer; given a printf-style
+// pattern such as "frame%05ld.qoi", each presented frame is also written
+// out, numbered from 0.
+class headless_target : public render_target {
+	private:
+		std::string pattern;
+		image_format format;
+		int64_t frames = 0;
+	public:
+		headless_target(std::string pattern = "",
+						image_format format = IMAGE_PPM);
+
+		~headless_target() {}
+
+		bool ready() const;
+
+		void present(const framebuffer &fb);
+
+		bool poll(SDL_Event &event);
+
+		int64_t frame_count() const;
+};
+
+#endif
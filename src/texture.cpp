@@ -0,0 +1,212 @@
+#include "texture.hpp"
+#include "MACROS.hpp"
+#include "image.hpp"
+
+#include <math.h>
+
+// Spreads the low 32 bits of x to the even bit positions.
+static inline uint64_t part1by1(uint64_t x) {
+	x &= 0xFFFFFFFF;
+	x = (x | (x << 16)) & 0x0000FFFF0000FFFF;
+	x = (x | (x << 8)) & 0x00FF00FF00FF00FF;
+	x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0F;
+	x = (x | (x << 2)) & 0x3333333333333333;
+	x = (x | (x << 1)) & 0x5555555555555555;
+	return x;
+}
+
+static inline int64_t pow2_ceil(int64_t n) {
+	int64_t p = 1;
+
+	while (p < n)
+		p <<= 1;
+
+	return p;
+}
+
+static inline int64_t log2_floor(int64_t n) {
+	int64_t b = 0;
+
+	while ((1ll << (b + 1)) <= n)
+		++b;
+
+	return b;
+}
+
+static inline int64_t wrap(int64_t x, int64_t n) {
+	if (x >= 0 && x < n)
+		return x;
+
+	x %= n;
+	return (x < 0 ? x + n : x);
+}
+
+static inline uint32_t lerp_texel(uint32_t a, uint32_t b, float t) {
+	uint32_t r = 0;
+
+	for (int64_t s = 0; s < 32; s += 8) {
+		float ca = (a >> s) & 0xFF, cb = (b >> s) & 0xFF;
+		r |= static_cast<uint32_t>(ca + (cb - ca) * t + 0.5f) << s;
+	}
+
+	return r;
+}
+
+texture::texture(const uint32_t *pixels, int64_t W, int64_t H) {
+	this->build(pixels, W, H);
+}
+
+texture::texture(std::string fn) {
+	int64_t W = 0, H = 0;
+	std::vector<uint32_t> pixels;
+
+	if (read_ppm(fn, W, H, pixels))
+		this->build(pixels.data(), W, H);
+}
+
+// Each level halves the one above with a 2x2 box filter, down to 1x1.
+void texture::build(const uint32_t *pixels, int64_t W, int64_t H) {
+	if (W <= 0 || H <= 0)
+		return;
+
+	int64_t w = W, h = H, total = 0;
+
+	while (true) {
+		int64_t pw = pow2_ceil(w), ph = pow2_ceil(h);
+
+		this->levels.push_back({ w, h, log2_floor(MIN(pw, ph)), total });
+		total += pw * ph;
+
+		if (w == 1 && h == 1)
+			break;
+
+		w = MAX(w / 2, (int64_t) 1);
+		h = MAX(h / 2, (int64_t) 1);
+	}
+
+	this->texels.assign(total, 0);
+
+	std::vector<uint32_t> current(pixels, pixels + W * H), next;
+
+	for (int64_t lvl = 0; lvl < this->level_count(); lvl++) {
+		this->store(lvl, current);
+
+		if (lvl + 1 == this->level_count())
+			break;
+
+		const mip_level &A = this->levels[lvl], &B = this->levels[lvl + 1];
+		next.assign(B.w * B.h, 0);
+
+		for (int64_t y = 0; y < B.h; y++) {
+			for (int64_t x = 0; x < B.w; x++) {
+				int64_t x0 = MIN(2 * x, A.w - 1), x1 = MIN(2 * x + 1, A.w - 1),
+						y0 = MIN(2 * y, A.h - 1), y1 = MIN(2 * y + 1, A.h - 1);
+
+				uint32_t p[4] = { current[y0 * A.w + x0], current[y0 * A.w + x1],
+								  current[y1 * A.w + x0], current[y1 * A.w + x1] };
+				uint32_t r = 0;
+
+				for (int64_t s = 0; s < 32; s += 8) {
+					uint32_t sum = ((p[0] >> s) & 0xFF) + ((p[1] >> s) & 0xFF) +
+								   ((p[2] >> s) & 0xFF) + ((p[3] >> s) & 0xFF);
+					r |= ((sum + 2) / 4) << s;
+				}
+
+				next[y * B.w + x] = r;
+			}
+		}
+
+		current.swap(next);
+	}
+}
+
+// Past the square of interleaved bits only the longer side has bits left,
+// and they select the square.
+int64_t texture::index(const mip_level &L, int64_t x, int64_t y) {
+	uint64_t low = (part1by1(x) | (part1by1(y) << 1)) & ((1ull << (2 * L.bits)) - 1),
+			 high = ((x | y) >> L.bits) << (2 * L.bits);
+
+	return L.offset + low + high;
+}
+
+void texture::store(int64_t lvl, const std::vector<uint32_t> &pixels) {
+	const mip_level &L = this->levels[lvl];
+
+	for (int64_t y = 0; y < L.h; y++)
+		for (int64_t x = 0; x < L.w; x++)
+			this->texels[index(L, x, y)] = pixels[y * L.w + x];
+}
+
+uint32_t texture::fetch(const mip_level &L, int64_t x, int64_t y) const {
+	return this->texels[index(L, wrap(x, L.w), wrap(y, L.h))];
+}
+
+uint32_t texture::nearest(int64_t lvl, float u, float v) const {
+	const mip_level &L = this->levels[lvl];
+
+	return this->fetch(L, (int64_t) floorf(u * L.w), (int64_t) floorf(v * L.h));
+}
+
+uint32_t texture::bilinear(int64_t lvl, float u, float v) const {
+	const mip_level &L = this->levels[lvl];
+
+	float s = u * L.w - 0.5f, t = v * L.h - 0.5f,
+		  fs = floorf(s), ft = floorf(t);
+
+	int64_t x = (int64_t) fs, y = (int64_t) ft;
+
+	uint32_t top = lerp_texel(this->fetch(L, x, y), this->fetch(L, x + 1, y), s - fs),
+			 bottom = lerp_texel(this->fetch(L, x, y + 1), this->fetch(L, x + 1, y + 1), s - fs);
+
+	return lerp_texel(top, bottom, t - ft);
+}
+
+bool texture::empty() const {
+	return this->levels.empty();
+}
+
+int64_t texture::width() const {
+	return (this->empty() ? 0 : this->levels[0].w);
+}
+
+int64_t texture::height() const {
+	return (this->empty() ? 0 : this->levels[0].h);
+}
+
+int64_t texture::level_count() const {
+	return this->levels.size();
+}
+
+// log2 of the longer screen axis footprint, in level 0 texels.
+float texture::lod(float dudx, float dvdx, float dudy, float dvdy) const {
+	float W = this->width(), H = this->height();
+
+	float x = (dudx * W) * (dudx * W) + (dvdx * H) * (dvdx * H),
+		  y = (dudy * W) * (dudy * W) + (dvdy * H) * (dvdy * H);
+
+	// log2(sqrt(r)) = 0.5 * log2(r).
+	return 0.5f * log2f(MAX(MAX(x, y), 1e-12f));
+}
+
+uint32_t texture::sample(float u, float v, float lod, texture_filter filter) const {
+	if (this->empty())
+		return 0xFFFFFFFF;
+
+	float top = this->level_count() - 1;
+
+	lod = MIN(MAX(lod, 0.0f), top);
+
+	if (filter == FILTER_NEAREST)
+		return this->nearest((int64_t) (lod + 0.5f), u, v);
+
+	if (filter == FILTER_BILINEAR)
+		return this->bilinear((int64_t) (lod + 0.5f), u, v);
+
+	int64_t lvl = (int64_t) lod;
+	float f = lod - lvl;
+
+	if (f == 0.0f)
+		return this->bilinear(lvl, u, v);
+
+	return lerp_texel(this->bilinear(lvl, u, v), this->bilinear(lvl + 1, u, v), f);
+}
@@ -0,0 +1,70 @@
+#ifndef TEXTURE_HPP
+#define TEXTURE_HPP
+
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+enum texture_filter {
+	// Nearest texel of the nearest mip level.
+	FILTER_NEAREST,
+	// Bilinear within the nearest mip level.
+	FILTER_BILINEAR,
+	// Bilinear in the two nearest mip levels, blended by the fraction.
+	FILTER_TRILINEAR
+};
+
+// RGBA8 texture (0xAABBGGRR, like framebuffer) with a full mip chain.
+// Every level is stored in Z-order: texel (x, y) sits at the bit
+// interleave of x and y, so a bilinear footprint and the texels of
+// neighbouring pixels mostly share cache lines. Coordinates are
+// normalized, (0, 0) at the top-left of the image, and wrap.
+class texture {
+	private:
+		// Sides are padded to powers of two; bits is log2 of the smaller
+		// padded side, the number of bits of x and y interleaved.
+		struct mip_level {
+			int64_t w, h, bits, offset;
+		};
+
+		std::vector<mip_level> levels;
+		std::vector<uint32_t> texels;
+
+		void build(const uint32_t *pixels, int64_t W, int64_t H);
+
+		static int64_t index(const mip_level &L, int64_t x, int64_t y);
+
+		void store(int64_t lvl, const std::vector<uint32_t> &pixels);
+
+		uint32_t fetch(const mip_level &L, int64_t x, int64_t y) const;
+
+		uint32_t nearest(int64_t lvl, float u, float v) const;
+
+		uint32_t bilinear(int64_t lvl, float u, float v) const;
+	public:
+		texture() {}
+
+		// W * H pixels, row by row.
+		texture(const uint32_t *pixels, int64_t W, int64_t H);
+
+		// Loads a binary PPM; empty when that fails.
+		texture(std::string fn);
+
+		~texture() {}
+
+		bool empty() const;
+
+		int64_t width() const;
+
+		int64_t height() const;
+
+		int64_t level_count() const;
+
+		// Mip level for UV derivatives along screen x and y.
+		float lod(float dudx, float dvdx, float dudy, float dvdy) const;
+
+		uint32_t sample(float u, float v, float lod, texture_filter filter) const;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include "thread_pool.hpp"
+
+thread_pool::thread_pool(int64_t N) : next(0) {
+	if (N <= 0)
+		N = std::thread::hardware_concurrency();
+
+	if (N <= 0)
+		N = 1;
+
+	for (int64_t k = 1; k < N; k++)
+		workers.emplace_back(&thread_pool::work, this, k);
+}
+
+thread_pool::~thread_pool() {
+	{
+		std::lock_guard<std::mutex> lock(m);
+		stop = true;
+	}
+
+	wake.notify_all();
+
+	for (std::thread &t : workers)
+		t.join();
+}
+
+int64_t thread_pool::size() const {
+	return workers.size() + 1;
+}
+
+void thread_pool::drain(int64_t worker) {
+	for (int64_t k = next++; k < jobs; k = next++)
+		(*job)(k, worker);
+}
+
+void thread_pool::work(int64_t worker) {
+	uint64_t seen = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(m);
+			wake.wait(lock, [&] { return stop || generation != seen; });
+
+			if (stop)
+				return;
+
+			seen = generation;
+		}
+
+		this->drain(worker);
+
+		std::lock_guard<std::mutex> lock(m);
+
+		if (--busy == 0)
+			finished.notify_one();
+	}
+}
+
+void thread_pool::run(int64_t N, const std::function<void(int64_t, int64_t)> &f) {
+	if (workers.empty() || N <= 1) {
+		for (int64_t k = 0; k < N; k++)
+			f(k, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m);
+		job = &f;
+		jobs = N;
+		next = 0;
+		busy = workers.size();
+		++generation;
+	}
+
+	wake.notify_all();
+
+	this->drain(0);
+
+	std::unique_lock<std::mutex> lock(m);
+	finished.wait(lock, [&] { return busy == 0; });
+	job = nullptr;
+}
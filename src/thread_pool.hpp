@@ -0,0 +1,45 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers for parallel-for style jobs. The calling thread
+// takes part as worker 0, so a pool of size 1 spawns no threads.
+class thread_pool {
+	private:
+		std::vector<std::thread> workers;
+		std::mutex m;
+		std::condition_variable wake, finished;
+
+		const std::function<void(int64_t, int64_t)> *job = nullptr;
+		std::atomic<int64_t> next;
+		int64_t jobs = 0, busy = 0;
+		uint64_t generation = 0;
+		bool stop = false;
+
+		void drain(int64_t worker);
+
+		void work(int64_t worker);
+	public:
+		// N <= 0 uses one worker per hardware thread.
+		thread_pool(int64_t N = 0);
+
+		thread_pool(const thread_pool &pool) = delete;
+
+		~thread_pool();
+
+		int64_t size() const;
+
+		// Calls f(k, worker) for every k in [0, N) and returns once all calls
+		// have finished. Jobs are handed out dynamically.
+		void run(int64_t N, const std::function<void(int64_t, int64_t)> &f);
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include "tile_renderer.hpp"
+
+tile_renderer::tile_renderer(int64_t W, int64_t H, int64_t threads) : pool(threads) {
+	columns = (W + TILE_SIZE - 1) / TILE_SIZE;
+	rows = (H + TILE_SIZE - 1) / TILE_SIZE;
+
+	bins.resize(columns * rows);
+	written.resize(pool.size());
+}
+
+int64_t tile_renderer::threads() const {
+	return pool.size();
+}
+
+void tile_renderer::submit(const raster_triangle &t) {
+	queue.push_back(t);
+	this->bin(queue.size() - 1);
+}
+
+// Adds the triangle to every tile its bounding box touches, skipping tiles
+// that lie entirely outside one of its edges.
+void tile_renderer::bin(uint32_t index) {
+	const raster_triangle &t = queue[index];
+	const int64_t S = TILE_SIZE;
+
+	for (int64_t ty = t.y0 / S; ty <= (t.y1 - 1) / S; ty++) {
+		for (int64_t tx = t.x0 / S; tx <= (t.x1 - 1) / S; tx++) {
+			bool outside = false;
+
+			for (int64_t k = 0; k < 3 && !outside; k++) {
+				const raster_edge &e = t.e[k];
+
+				int64_t hi = e.a * (tx * S) + e.b * (ty * S) + e.c +
+							 (MAX(e.a, (int64_t) 0) + MAX(e.b, (int64_t) 0)) * (S - 1);
+
+				outside = (hi < 0);
+			}
+
+			if (!outside)
+				bins[ty * columns + tx].push_back(index);
+		}
+	}
+}
+
+int64_t tile_renderer::flush(rasterizer &raster) {
+	if (queue.empty())
+		return 0;
+
+	for (worker_count &w : written)
+		w.n = 0;
+
+	pool.run(columns * rows, [&](int64_t tile, int64_t worker) {
+		std::vector<uint32_t> &B = bins[tile];
+
+		int64_t x0 = (tile % columns) * TILE_SIZE,
+				y0 = (tile / columns) * TILE_SIZE;
+
+		int64_t n = 0;
+
+		for (uint32_t index : B)
+			n += raster.draw(queue[index], x0, y0, x0 + TILE_SIZE, y0 + TILE_SIZE);
+
+		written[worker].n += n;
+
+		B.clear();
+	});
+
+	queue.clear();
+
+	int64_t total = 0;
+
+	for (const worker_count &w : written)
+		total += w.n;
+
+	return total;
+}
@@ -0,0 +1,45 @@
+#ifndef TILE_RENDERER_HPP
+#define TILE_RENDERER_HPP
+
+#pragma once
+#include "rasterizer.hpp"
+#include "thread_pool.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+#define TILE_SIZE 64
+
+// Sort-middle renderer: set-up triangles are queued and binned into
+// TILE_SIZE square screen tiles, then tiles are rasterized in parallel.
+// Each tile is drawn by one worker, clipped to its own pixels, so workers
+// never share color or depth and need no locks. Bins are filled in
+// submission order, which keeps draw order within a tile.
+class tile_renderer {
+	private:
+		thread_pool pool;
+		int64_t columns, rows;
+
+		std::vector<raster_triangle> queue;
+		std::vector<std::vector<uint32_t>> bins;
+
+		// Pixels written by each worker during a flush, a cache line apart.
+		struct alignas(64) worker_count { int64_t n = 0; };
+		std::vector<worker_count> written;
+
+		void bin(uint32_t index);
+	public:
+		tile_renderer(int64_t W, int64_t H, int64_t threads = 0);
+
+		~tile_renderer() {}
+
+		int64_t threads() const;
+
+		void submit(const raster_triangle &t);
+
+		// Rasterizes and clears everything queued since the last flush.
+		// Returns the number of pixels written.
+		int64_t flush(rasterizer &raster);
+};
+
+#endif
@@ -17,52 +17,193 @@ color interpolate_color(color& c1,
                  c1.B() * P + c2.B() * (1-P));
 }
 
-// Initializes SDL Window
-void window::initialize_window() {
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        SDL_Log("Failed to initialize SDL Window: %s\n", SDL_GetError());
-        return;
-    }
+static raster_vertex raster_coords(const vec2<double>& v) {
+	raster_vertex R;
+
+	R.x = v.x();
+	R.y = v.y();
+	R.z = 0.0;
+
+	return R;
+}
+
+static void raster_color(raster_vertex& R, color c) {
+	R.v[0] = c.R();
+	R.v[1] = c.G();
+	R.v[2] = c.B();
+}
+
+// Red, green and blue corners, assigned from the top of the screen down.
+static void raster_rainbow(raster_vertex V[3]) {
+	if (V[0].y > V[1].y)
+		std::swap(V[0], V[1]);
+
+	if (V[1].y > V[2].y)
+		std::swap(V[1], V[2]);
+
+	if (V[0].y > V[1].y)
+		std::swap(V[0], V[1]);
+
+	raster_color(V[0], color::RED());
+	raster_color(V[1], color::GREEN());
+	raster_color(V[2], color::BLUE());
+}
+
+// As above, for clip space corners. Screen y grows with y / w.
+static void clip_rainbow(clip_vertex V[3]) {
+	auto below = [](const clip_vertex& a, const clip_vertex& b) {
+		return a.y / a.w > b.y / b.w;
+	};
 
-    this->w = SDL_CreateWindow("balls",
-   							   SDL_WINDOWPOS_CENTERED,
-							   SDL_WINDOWPOS_CENTERED,
-							   this->width,
-							   this->height,
-							   SDL_WINDOW_SHOWN);
+	if (below(V[0], V[1]))
+		std::swap(V[0], V[1]);
 
-    if (!this->w) {
-        SDL_Log("Failed to initialize SDL Window: %s\n", SDL_GetError());
-        SDL_Quit();
-        return;
-    }
+	if (below(V[1], V[2]))
+		std::swap(V[1], V[2]);
 
-    this->r = SDL_CreateRenderer(this->w, -1, SDL_RENDERER_ACCELERATED);
+	if (below(V[0], V[1]))
+		std::swap(V[0], V[1]);
 
-    if (!this->r) {
-        SDL_Log("Failed to initialize SDL Window: %s\n", SDL_GetError());
-        SDL_DestroyWindow(w);
-        SDL_Quit();
-        return;
-    }
+	color corners[3] = { color::RED(), color::GREEN(), color::BLUE() };
 
-    this->init = true;
+	for (int64_t k = 0; k < 3; k++) {
+		V[k].v[0] = corners[k].R();
+		V[k].v[1] = corners[k].G();
+		V[k].v[2] = corners[k].B();
+	}
+}
+
+// Opens an SDL window unless a target was given.
+void window::initialize_window() {
+	if (!this->target)
+		this->target = new sdl_target(this->width, this->height);
+
+	this->init = this->target->ready();
+}
+
+void window::initialize_framebuffer() {
+	this->fb = new framebuffer(this->width, this->height);
+	this->raster = new rasterizer(this->fb);
+	this->guard = MIN(CLIP_GUARD_BAND, RASTER_MAX_COORD / (double) MAX(this->width, this->height) - 1.0);
 }
 
 void window::initialize_camera() {
     this->cam = new camera(this->width, this->height);
     this->cam->compute_screen_coordinates(DEFAULT_NEAR_DISTANCE, DEFAULT_FAR_DISTANCE);
-	view_mat = new mat4<double>(cam->camera_view());
+}
+
+// Surface color c under the diffuse light gathered for point k of B.
+static color lit_color(const color &c,
+					   const light_batch &B,
+					   int64_t k) {
+	return color(MIN(c.R() * B.r[k], 255.0f),
+				 MIN(c.G() * B.g[k], 255.0f),
+				 MIN(c.B() * B.b[k], 255.0f),
+				 c.A());
 }
 
 void window::initialize_light() {
-	this->l = new light();
+	this->lights = new light_list();
+	this->lights->add(light());
 }
 
 void window::set_render_color(color c, bool cache) {
 	if (cache)
-		this->current_color = new color(c);
-    SDL_SetRenderDrawColor(this->r, c.R(), c.G(), c.B(), c.A());
+		this->state.current = c;
+
+	uint32_t packed = pack_color(c);
+
+	if (packed == this->state.draw)
+		return;
+
+	this->state.draw = packed;
+	++this->state_changes_issued;
+}
+
+void window::set_frame_rate(double fps) {
+	if (this->pacer.mode() == PACE_VSYNC)
+		this->target->vsync(false);
+
+	this->pacer.frame_rate(fps);
+}
+
+bool window::set_vsync(bool enabled) {
+	if (!enabled) {
+		this->set_frame_rate(DEFAULT_FRAME_RATE);
+		return true;
+	}
+
+	if (!this->target->vsync(true))
+		return false;
+
+	this->pacer.vsync();
+	return true;
+}
+
+frame_stats window::frame_times() const {
+	return this->pacer.stats();
+}
+
+void window::set_blend_mode(blend_mode mode) {
+	if (mode == this->state.blend)
+		return;
+
+	this->state.blend = mode;
+	++this->state_changes_issued;
+}
+
+blend_mode window::get_blend_mode() const {
+	return this->state.blend;
+}
+
+void window::set_shading_mode(shading_mode mode) {
+	if (mode == this->state.shading)
+		return;
+
+	this->state.shading = mode;
+	++this->state_changes_issued;
+}
+
+shading_mode window::get_shading_mode() const {
+	return this->state.shading;
+}
+
+void window::set_texture(const texture *tex,
+						 texture_filter filter) {
+	if (tex == this->state.tex && filter == this->state.filter)
+		return;
+
+	this->state.tex = tex;
+	this->state.filter = filter;
+	++this->state_changes_issued;
+}
+
+const texture* window::get_texture() const {
+	return this->state.tex;
+}
+
+void window::set_line_mode(line_mode mode) {
+	if (mode == this->state.line)
+		return;
+
+	this->state.line = mode;
+	++this->state_changes_issued;
+}
+
+line_mode window::get_line_mode() const {
+	return this->state.line;
+}
+
+light_list& window::get_lights() {
+	return *this->lights;
+}
+
+int64_t window::state_changes() const {
+	return this->state_changes_last;
+}
+
+const frame_profile& window::last_profile() const {
+	return this->profile.last_frame();
 }
 
 vec2<double> window::ndc_to_screen_coords(const vec4<double>& ndc_vert) const {
@@ -81,6 +222,43 @@ vec2<double> window::cartesian_to_screen_coords(const vec4<double>& vert) const
     return this->ndc_to_screen_coords(ndc_vert);
 }
 
+clip_vertex window::clip_coords(const vec4<double>& vert) const {
+	vec4<double> c = (cam->view_projection() * vert);
+	clip_vertex C;
+
+	C.x = c.x();
+	C.y = c.y();
+	C.z = c.z();
+	C.w = c.w();
+
+	return C;
+}
+
+raster_vertex window::clip_to_raster(const clip_vertex& vert) const {
+	raster_vertex R;
+	double inv_w = 1.0 / vert.w;
+
+	R.x = (vert.x * inv_w + 1) * (this->width/2.0);
+	R.y = (vert.y * inv_w + 1) * (this->height/2.0);
+	R.z = vert.z * inv_w;
+	R.inv_w = inv_w;
+
+	for (int64_t k = 0; k < RASTER_MAX_VARYINGS; k++)
+		R.v[k] = vert.v[k];
+
+	return R;
+}
+
+bool window::depth_visible(const vec4<double>& view_vert) const {
+	vec4<double> c = (cam->projection() * view_vert);
+	clip_vertex C;
+
+	C.z = c.z();
+	C.w = c.w();
+
+	return clip_depth_visible(C);
+}
+
 list<vec2<double>> window::cartesian_to_screen_coords(const list<vec3<double>> &points) const {
 	list<vec4<double>> convert;
 
@@ -119,35 +297,44 @@ list<vec2<double>> window::cartesian_to_screen_coords(const list<vec4<double>> &
 
 window::window() {
     initialize_window();
+	initialize_framebuffer();
     initialize_camera();
 	initialize_light();
 }
 
 window::window(const int64_t W, const int64_t H) : width(W), height(H) {
     initialize_window();
+	initialize_framebuffer();
     initialize_camera();
 	initialize_light();
 }
 
 window::window(const int64_t W, const int64_t H, const int64_t D) : width(W),
                                                                     height(H),
-                                                                    delay(D) {
+                                                                    pacer(D > 0 ? 1000.0 / D : 0) {
     initialize_window();
+	initialize_framebuffer();
     initialize_camera();
 	initialize_light();
 }
 
-window::~window() {
-	free(cam);
-	free(view_mat);
-
-    if (this->r) 
-        SDL_DestroyRenderer(this->r);
+window::window(render_target *T, const int64_t W, const int64_t H) : width(W), height(H) {
+	this->target = T;
+	this->pacer.uncapped();
 
-    if (this->w) 
-        SDL_DestroyWindow(this->w);
+    initialize_window();
+	initialize_framebuffer();
+    initialize_camera();
+	initialize_light();
+}
 
-    SDL_Quit();
+window::~window() {
+	delete cam;
+	delete lights;
+	delete tiles;
+	delete raster;
+	delete fb;
+	delete target;
 }
 
 int64_t window::time() const {
@@ -166,14 +353,66 @@ bool window::is_initialized() const {
     return init;
 }
 
+void window::set_simd(bool enabled) {
+	this->raster->use_simd(enabled);
+	this->lights->use_simd(enabled);
+}
+
+bool window::simd_enabled() const {
+	return this->raster->simd_enabled();
+}
+
+void window::set_render_mode(render_mode mode,
+							 int64_t threads) {
+	delete this->tiles;
+	this->tiles = nullptr;
+
+	if (mode == RENDER_TILED)
+		this->tiles = new tile_renderer(this->width, this->height, threads);
+}
+
+render_mode window::mode() const {
+	return (this->tiles ? RENDER_TILED : RENDER_IMMEDIATE);
+}
+
+void window::set_culling(bool enabled,
+						 face_winding front) {
+	this->culling = enabled;
+	this->front_face = front;
+}
+
+bool window::culling_enabled() const {
+	return this->culling;
+}
+
+int64_t window::culled_faces() const {
+	return this->culled;
+}
+
+void window::reset_culled_faces() {
+	this->culled = 0;
+}
+
 void window::fill_background(color c) {
     this->set_render_color(c);
-    SDL_RenderClear(this->r);
+	this->fb->clear(this->state.draw);
+	this->fb->clear_depth();
 }
 
 // Assume point is already in terms of screen coordinates.
 void window::draw_point(const vec2<double>& point) {
-    SDL_RenderDrawPoint(this->r, point.x(), point.y());
+	this->plot(std::floor(point.x()), std::floor(point.y()), this->state.draw);
+}
+
+void window::plot(int64_t x, int64_t y, uint32_t c) {
+	bool blended = (this->state.blend == BLEND_ALPHA);
+
+	if (this->recording)
+		this->recording->point(x, y, c, blended);
+	else if (blended)
+		this->fb->blend(x, y, c);
+	else
+		this->fb->set(x, y, c);
 }
 
 void window::draw_point(const vec3<double>& point) {
@@ -183,13 +422,9 @@ void window::draw_point(const vec3<double>& point) {
 }
 
 void window::draw_point(const vec4<double>& point) {
-	vec4<double> transformed_point = (*view_mat * point);
-
-    // Converts vertex from 3D space to NDC 
-    if (ABS(transformed_point.z()) <= DEFAULT_Z_THRESH) 
-        return;
+	vec4<double> transformed_point = (cam->view() * point);
 
-	if (transformed_point.z() > 0)
+	if (!this->depth_visible(transformed_point))
 		return;
 
 	vec2<double> screen = cartesian_to_screen_coords(transformed_point);
@@ -214,7 +449,34 @@ void window::draw_point(const vec4<double>& point, color& c) {
 
 void window::draw_line(const vec2<double>& p1, 
                        const vec2<double>& p2) {
-    SDL_RenderDrawLine(this->r, p1.x(), p1.y(), p2.x(), p2.y());
+	raster_segment S;
+
+	S.x1 = p1.x();
+	S.y1 = p1.y();
+	S.x2 = p2.x();
+	S.y2 = p2.y();
+	S.c1 = S.c2 = this->state.draw;
+
+	this->draw_segment(S);
+}
+
+void window::draw_segment(const raster_segment& s) {
+	bool blended = (this->state.blend == BLEND_ALPHA),
+		 smooth = (this->state.line == LINE_SMOOTH);
+
+	if (this->recording)
+		this->recording->line(s, blended, smooth);
+	else
+		this->rasterize_line(s, blended, smooth);
+}
+
+void window::rasterize_line(const raster_segment& s,
+							bool blended,
+							bool smooth) {
+	int64_t written = (smooth ? raster_line_smooth(this->fb, s)
+							  : raster_line(this->fb, s, blended));
+
+	PROFILE_COUNT(this->profile, COUNT_PIXELS, written);
 }
 
 void window::draw_line(const vec3<double>& p1, 
@@ -227,19 +489,32 @@ void window::draw_line(const vec3<double>& p1,
 
 void window::draw_line(const vec4<double>& p1,
                        const vec4<double>& p2) {
-	vec4<double> t1 = (*view_mat * p1),	
-			     t2 = (*view_mat * p2);
-
-	if (ABS(t1.z()) <= DEFAULT_Z_THRESH || ABS(t2.z()) <= DEFAULT_Z_THRESH) 
-        return;
+	this->draw_clipped_line(clip_coords(p1), clip_coords(p2));
+}
 
-	if (t1.z() > 0 || t2.z() > 0)
+void window::draw_clipped_line(clip_vertex a,
+							   clip_vertex b,
+							   bool colored) {
+	if (!clip_line(a, b, colored ? 3 : 0))
 		return;
 
-	vec2<double> first = cartesian_to_screen_coords(t1),
-				 second = cartesian_to_screen_coords(t2);
+	raster_vertex first = clip_to_raster(a),
+				  second = clip_to_raster(b);
 
-    this->draw_line(first, second);
+	raster_segment S;
+
+	S.x1 = first.x;
+	S.y1 = first.y;
+	S.x2 = second.x;
+	S.y2 = second.y;
+	S.c1 = S.c2 = this->state.draw;
+
+	if (colored) {
+		S.c1 = pack_color(color(a.v[0], a.v[1], a.v[2]));
+		S.c2 = pack_color(color(b.v[0], b.v[1], b.v[2]));
+	}
+
+	this->draw_segment(S);
 }
 
 void window::draw_line(const vec2<double>& p1,
@@ -308,12 +583,9 @@ void window::draw_wireframe_circle(const vec3<double>& center,
 
 void window::draw_wireframe_circle(const vec4<double>& center,
                                    const double radius) {
-	vec4<double> tc = (*view_mat * center);
-
-    if (ABS(tc.z()) <= DEFAULT_Z_THRESH) 
-		return;
+	vec4<double> tc = (cam->view() * center);
 
-	if (tc.z() > 0)
+	if (!this->depth_visible(tc))
 		return;
 
 	vec4<double> top = tc + vec4<double>(0.0, radius, 0.0, 0.0);
@@ -345,37 +617,35 @@ void window::draw_wireframe_circle(const vec4<double>& center,
     this->draw_wireframe_circle(center, radius);
 }
 
-// Brensenham's Circle Drawing Algorithm (Again)
 void window::draw_filled_circle(const vec2<double>& center, 
                                 const double radius) {
+	raster_circle D;
 
-    int64_t D = 3 - (2 * radius);
-    int64_t x = 0, y = radius;
+	D.x = center.x();
+	D.y = center.y();
+	D.r = radius;
+	D.c = this->state.draw;
 
-    do {
-		vec2<double> v1 = center + vec2(x,y),
-					 v2 = center + vec2(x,-y),
-					 v3 = center + vec2(y,x),
-					 v4 = center + vec2(y,-x),
-					 v5 = center - vec2(x,y),
-					 v6 = center - vec2(x,-y),
-					 v7 = center - vec2(y,x),
-					 v8 = center - vec2(y,-x);
-
-        this->draw_line(v1, v2);
-        this->draw_line(v3, v4);
-        this->draw_line(v5, v6);
-        this->draw_line(v7, v8);
+	this->draw_disc(D, false);
+}
 
-        if (D <= 0) {
-            D += 4 * x + 6;
-        } else {
-            D += 4 * (x-y) + 10;
-            --y;
-        }
+void window::draw_disc(const raster_circle& d,
+					   bool smooth) {
+	bool blended = (this->state.blend == BLEND_ALPHA);
 
-        ++x;
-    } while (x < y);
+	if (this->recording)
+		this->recording->disc(d, blended, smooth);
+	else
+		this->rasterize_disc(d, blended, smooth);
+}
+
+void window::rasterize_disc(const raster_circle& d,
+							bool blended,
+							bool smooth) {
+	int64_t written = (smooth ? raster_disc_smooth(this->fb, d)
+							  : raster_disc(this->fb, d, blended));
+
+	PROFILE_COUNT(this->profile, COUNT_PIXELS, written);
 }
 
 void window::draw_filled_circle(const vec3<double>& center,
@@ -387,12 +657,9 @@ void window::draw_filled_circle(const vec3<double>& center,
 
 void window::draw_filled_circle(const vec4<double>& center,
                                 const double radius) {
-	vec4<double> tc = (*view_mat * center);
-
-    if (ABS(tc.z()) <= DEFAULT_Z_THRESH)
-        return;
+	vec4<double> tc = (cam->view() * center);
 
-	if (tc.z() > 0)
+	if (!this->depth_visible(tc))
 		return;
 
     vec4<double> top = tc + vec4<double>(0.0, radius, 0.0, 0.0);
@@ -400,7 +667,7 @@ void window::draw_filled_circle(const vec4<double>& center,
     vec2<double> screen_center = cartesian_to_screen_coords(tc),
                  screen_top = cartesian_to_screen_coords(top);
 
-    this->draw_wireframe_circle(screen_center, (screen_top.y() - screen_center.y()));
+    this->draw_filled_circle(screen_center, ABS((screen_top.y() - screen_center.y())));
 }
 
 void window::draw_filled_circle(const vec2<double>& center,
@@ -447,21 +714,13 @@ void window::draw_wireframe_triangle(const vec3<double>& v1,
 void window::draw_wireframe_triangle(const vec4<double>& v1,
                                      const vec4<double>& v2,
                                      const vec4<double>& v3) {
-	vec4<double> t1 = (*view_mat * v1),
-				 t2 = (*view_mat * v2),
-				 t3 = (*view_mat * v3);
-
-	if (ABS(t1.z()) <= DEFAULT_Z_THRESH || ABS(t2.z()) <= DEFAULT_Z_THRESH || ABS(t3.z()) <= DEFAULT_Z_THRESH)
-		return;
+	clip_vertex c1 = clip_coords(v1),
+				c2 = clip_coords(v2),
+				c3 = clip_coords(v3);
 
-	if (t1.z() > 0 || t2.z() > 0 || t3.z() > 0)
-		return;
-
-    vec2<double> v1_screen = cartesian_to_screen_coords(t1),
-                 v2_screen = cartesian_to_screen_coords(t2),     
-                 v3_screen = cartesian_to_screen_coords(t3);
-
-    this->draw_wireframe_triangle(v1_screen, v2_screen, v3_screen);
+	this->draw_clipped_line(c1, c2);
+	this->draw_clipped_line(c1, c3);
+	this->draw_clipped_line(c2, c3);
 }
 
 void window::draw_wireframe_triangle(const triangle& T) {
@@ -506,37 +765,10 @@ void window::draw_wireframe_triangle(const triangle& T,
 void window::draw_filled_triangle(vec2<double>& v1,
                                   vec2<double>& v2,
                                   vec2<double>& v3) {
-    // Sort v1, v2, v3 by ascending y value
-    if (v1.y() > v2.y()) 
-        std::swap(v1, v2);
-
-    if (v2.y() > v3.y())
-        std::swap(v2, v3);
-
-    if (v1.y() > v2.y())
-        std::swap(v1, v2);
-
-    double bounds = v2.y();
-
-	double min = MIN(MIN(v1.x(), v2.x()), v3.x()),
-		   max = MAX(MAX(v1.x(), v2.x()), v3.x());
-
-    for (int64_t y = v1.y(); y <= v3.y(); y++) {
-        double x1 = (y <= bounds ? 
-                     interp<double>(v1.x(), v1.y(), v2.x(), v2.y(), y) : 
-                     interp<double>(v2.x(), v2.y(), v3.x(), v3.y(), y));
-
-        double x2 = interp<double>(v1.x(), v1.y(), v3.x(), v3.y(), y);
-
-		if (x1 > max || x2 > max || x1 < min || x2 < min) {
-			continue;
-		}
-
-		vec2<double> p1 = vec2<double>(x1, y),
-					 p2 = vec2<double>(x2, y);
+	raster_vertex V[3] = { raster_coords(v1), raster_coords(v2), raster_coords(v3) };
 
-        this->draw_line(p1, p2);
-    }
+	PROFILE_COUNT(this->profile, COUNT_SUBMITTED, 1);
+	this->fill_triangle(V, RASTER_FLAT, false);
 }
 
 void window::draw_filled_triangle(vec3<double>& v1,
@@ -552,21 +784,139 @@ void window::draw_filled_triangle(vec3<double>& v1,
 void window::draw_filled_triangle(vec4<double>& v1,
                                   vec4<double>& v2,
                                   vec4<double>& v3) {
-	vec4<double> t1 = (*view_mat * v1),
-				 t2 = (*view_mat * v2),
-				 t3 = (*view_mat * v3);
+	clip_vertex V[3] = { clip_coords(v1), clip_coords(v2), clip_coords(v3) };
 
-	if (ABS(t1.z()) <= DEFAULT_Z_THRESH || ABS(t2.z()) <= DEFAULT_Z_THRESH || ABS(t3.z()) <= DEFAULT_Z_THRESH)
+	PROFILE_COUNT(this->profile, COUNT_SUBMITTED, 1);
+	this->fill_clipped_triangle(V, RASTER_FLAT);
+}
+
+void window::fill_clipped_triangle(const clip_vertex V[3],
+								   raster_shading shading) {
+	clip_vertex P[CLIP_MAX_VERTICES];
+	bool clipped = false;
+	int64_t N = clip_triangle(V, P, raster_varyings(shading), this->guard, &clipped);
+
+	PROFILE_COUNT(this->profile, COUNT_CLIPPED, clipped);
+
+	if (N < 3)
 		return;
 
-	if (t1.z() > 0 || t2.z() > 0 || t3.z() > 0)
+	raster_vertex R[CLIP_MAX_VERTICES];
+
+	for (int64_t k = 0; k < N; k++)
+		R[k] = clip_to_raster(P[k]);
+
+	for (int64_t k = 1; k + 1 < N; k++) {
+		raster_vertex T[3] = { R[0], R[k], R[k + 1] };
+
+		this->fill_triangle(T, shading, true);
+	}
+}
+
+// Single entry point into the rasterizer for flat and per-vertex color fills.
+void window::fill_triangle(const raster_vertex V[3],
+						   raster_shading shading,
+						   bool depth_test) {
+	raster_triangle T;
+
+	if (!this->raster->setup(T, V[0], V[1], V[2], raster_varyings(shading)))
 		return;
 
-    vec2<double> c1 = cartesian_to_screen_coords(t1),
-                 c2 = cartesian_to_screen_coords(t2),
-                 c3 = cartesian_to_screen_coords(t3);
+	T.shading = shading;
+	T.flat = this->state.draw;
+	T.depth_test = depth_test;
+	T.blend = (this->state.blend == BLEND_ALPHA);
+	T.lighting = &this->lighting;
+	T.tex = this->state.tex;
+	T.filter = this->state.filter;
+
+	this->submit_triangle(T);
+}
+
+void window::submit_triangle(const raster_triangle& T) {
+	if (this->recording) {
+		this->recording->triangle(T);
+		return;
+	}
+
+	PROFILE_COUNT(this->profile, COUNT_RASTERIZED, 1);
+
+	if (this->batching && this->tiles)
+		this->tiles->submit(T);
+	else if (this->batching && T.micro && T.depth_test && !T.blend)
+		this->micro.push_back(T);
+	else {
+		int64_t written = this->raster->draw(T);
+		PROFILE_COUNT(this->profile, COUNT_PIXELS, written);
+	}
+}
+
+void window::begin_recording(command_buffer& buffer) {
+	this->recording = &buffer;
+}
+
+void window::end_recording() {
+	this->recording = nullptr;
+}
+
+void window::replay(const command_buffer& buffer,
+					command_sort sort) {
+	std::vector<int64_t> order;
+	buffer.order(sort, order);
+
+	PROFILE_SCOPE(this->profile, STAGE_RASTER);
+
+	this->begin_batch();
+
+	for (int64_t k : order) {
+		const draw_command &C = buffer[k];
+
+		// Queued triangles land before anything drawn directly.
+		if (C.type != COMMAND_TRIANGLE) {
+			this->end_batch();
+			this->begin_batch();
+		}
+
+		switch (C.type) {
+			case COMMAND_TRIANGLE:
+				this->submit_triangle(buffer.triangle_at(C.triangle));
+				break;
+			case COMMAND_LINE:
+				this->rasterize_line(C.segment, C.blend, C.smooth);
+				break;
+			case COMMAND_POINT:
+				if (C.blend)
+					this->fb->blend(C.x, C.y, C.color);
+				else
+					this->fb->set(C.x, C.y, C.color);
+				break;
+			case COMMAND_DISC:
+				this->rasterize_disc(C.disc, C.blend, C.smooth);
+				break;
+		}
+	}
+
+	this->end_batch();
+}
 
-    return this->draw_filled_triangle(c1, c2, c3);
+void window::begin_batch() {
+	this->batching = true;
+}
+
+void window::end_batch() {
+	this->batching = false;
+
+	int64_t written = 0;
+
+	if (this->tiles)
+		written += this->tiles->flush(*this->raster);
+
+	if (!this->micro.empty()) {
+		written += this->raster->draw_micro(this->micro.data(), this->micro.size());
+		this->micro.clear();
+	}
+
+	PROFILE_COUNT(this->profile, COUNT_PIXELS, written);
 }
 
 void window::draw_filled_triangle(const triangle& T) {
@@ -610,7 +960,7 @@ void window::draw_filled_triangle(const triangle& T,
 void window::flat_shaded_triangle(vec3<double> v1,
 								  vec3<double> v2,
 								  vec3<double> v3) {
-	color c = *(this->current_color);
+	color c = this->state.current;
 	this->flat_shaded_triangle(v1, v2, v3, c);
 }
 
@@ -629,7 +979,13 @@ void window::flat_shaded_triangle(vec3<double> v1,
 
 	vec3 N = ((v2 - v1).cross(v3 - v1)).normalize();
 
-	color diffuse = light::diffuse(l->norm_pos(), N, c);
+	this->lights->update(cam->pos());
+
+	this->batch.resize(1);
+	this->batch.set(0, N, cam->pos() - (v1 + v2 + v3) / 3.0);
+	this->lights->diffuse(this->batch);
+
+	color diffuse = lit_color(c, this->batch, 0);
 
 	this->set_render_color(diffuse, false);
 	this->draw_filled_triangle(v1, v2, v3);
@@ -670,9 +1026,9 @@ void window::draw_wireframe_rectangle(const vec3<double> &top_left,
 void window::draw_wireframe_rectangle(const vec4<double> &top_left,
 									  const double length, 
 									  const double width) {
-	vec4<double> tc = (*view_mat * top_left);
+	vec4<double> tc = (cam->view() * top_left);
 
-	if (ABS(tc.z()) <= DEFAULT_Z_THRESH || tc.z() > 0)
+	if (!this->depth_visible(tc))
 		return;
 
 	vec4<double> right = tc + vec4(length, 0.0, 0.0, 0.0),
@@ -768,9 +1124,9 @@ void window::draw_filled_rectangle(const vec3<double> &top_left,
 void window::draw_filled_rectangle(const vec4<double> &top_left,
 								   const double length,
 								   const double width) {
-	vec4<double> tc = (*view_mat * top_left);
+	vec4<double> tc = (cam->view() * top_left);
 
-	if (ABS(tc.z()) <= DEFAULT_Z_THRESH || tc.z() > 0)
+	if (!this->depth_visible(tc))
 		return;
 
 	vec4<double> right = tc + vec4(length, 0.0, 0.0, 0.0),
@@ -847,7 +1203,7 @@ void window::draw_filled_square(const vec4<double> &top_left,
 }
 
 void window::tick() {
-	while (SDL_PollEvent(&event)) {
+	while (this->target->poll(event)) {
 		if (event.type == SDL_QUIT)
 			quit = true;
 
@@ -861,7 +1217,6 @@ void window::tick() {
 
 				tv *= CAMERA_SPEED;
 				cam->translate(tv);
-				view_mat = new mat4<double>(cam->camera_view());
 			}
 
 			switch (k) {
@@ -877,7 +1232,6 @@ void window::tick() {
 			// inwards zoom
 			vec3<double> tv = vec3<double>(0, 0, (event.wheel.y > 0 ? -CAMERA_SPEED : event.wheel.y < 0 ? CAMERA_SPEED : 0));
 			cam->translate(tv);
-			view_mat = new mat4<double>(cam->camera_view());
 		}
 	}
 
@@ -887,85 +1241,45 @@ void window::tick() {
 }
 
 void window::present() {
-	SDL_RenderPresent(this->r);
-	SDL_Delay(this->delay);
+	{
+		PROFILE_SCOPE(this->profile, STAGE_PRESENT);
+		this->target->present(*this->fb);
+	}
+
+	this->pacer.wait();
+
+	PROFILE_COUNT(this->profile, COUNT_STATE_CHANGES, this->state_changes_issued);
+	this->profile.end_frame();
+
+	this->state_changes_last = this->state_changes_issued;
+	this->state_changes_issued = 0;
 }
 
-// DDA Algorithm
 void window::draw_colored_line(vec2<double>& v1,
                                vec2<double>& v2,
                                color& c1, 
                                color& c2) {
+	raster_segment S;
 
-    if (v1.x() > v2.x())
-        std::swap(v1, v2);
-
-    double dx = (v2.x() - v1.x()),
-           dy = (v2.y() - v1.y()),
-           x = v1.x(),
-           y = MIN(v1.y(), v2.y()),
-           k = 0,
-           step = MAX(ABS(dx), ABS(dy));
-
-    dx /= step;
-    dy /= step;
-
-    while (k <= step) {
-        double P = k / step;
-
-        color point_color = interpolate_color(c1, c2, P);
-
-		vec2<double> point = vec2(x,y);
-    
-        this->draw_point(point, point_color);
+	S.x1 = v1.x();
+	S.y1 = v1.y();
+	S.x2 = v2.x();
+	S.y2 = v2.y();
+	S.c1 = pack_color(c1);
+	S.c2 = pack_color(c2);
 
-        x += dx;
-        y += dy;
-        ++k;
-    }
+	this->draw_segment(S);
 }
 
 void window::draw_rainbow_triangle(vec2<double>& v1,
                                    vec2<double>& v2,
                                    vec2<double>& v3) {
-    if (v1.y() > v2.y())
-        std::swap(v1, v2);
-
-    if (v2.y() > v3.y())
-        std::swap(v2, v3);
-
-    if (v1.y() > v2.y())
-        std::swap(v1, v2);
-
-    double bounds = v2.y();
-
-	vec3<double> c1 = vec3(v1, 1.0),
-				 c2 = vec3(v2, 1.0),
-				 c3 = vec3(v3, 1.0);
-
-    for (int64_t y = v1.y(); y <= v3.y(); y++) {
-        double x1 = (y <= bounds ? 
-                     interp<double>(v1.x(), v1.y(), v2.x(), v2.y(), y) : 
-                     interp<double>(v2.x(), v2.y(), v3.x(), v3.y(), y));
-
-        double x2 = interp<double>(v1.x(), v1.y(), v3.x(), v3.y(), y);
+	raster_vertex V[3] = { raster_coords(v1), raster_coords(v2), raster_coords(v3) };
 
-		if (std::isinf(x1) || std::isinf(x2))
-			continue;
+	raster_rainbow(V);
 
-        for (int64_t x = MIN(x1, x2); x <= MAX(x1, x2); x++) {
-            vec2<double> point = vec2<double>(x, y);
-
-            vec3<double> bary = barycentric(c1,
-                                            c2,
-                                            c3,
-                                            vec3(point, 1.0));
-
-            color c(0xFF * bary[0], 0xFF * bary[1], 0xFF * bary[2]);
-
-            this->draw_point(point, c);
-        }
-    }
+	PROFILE_COUNT(this->profile, COUNT_SUBMITTED, 1);
+	this->fill_triangle(V, RASTER_COLOR, false);
 }
 
 void window::draw_rainbow_triangle(const vec3<double>& v1,
@@ -981,21 +1295,11 @@ void window::draw_rainbow_triangle(const vec3<double>& v1,
 void window::draw_rainbow_triangle(const vec4<double>& v1,
                                    const vec4<double>& v2,
                                    const vec4<double>& v3) {
-	vec4<double> t1 = (*view_mat * v1),
-			     t2 = (*view_mat * v2),
-				 t3 = (*view_mat * v3);
-
-	if (ABS(t1.z()) <= DEFAULT_Z_THRESH || ABS(t2.z()) <= DEFAULT_Z_THRESH || ABS(t3.z()) <= DEFAULT_Z_THRESH)
-		return;
+	clip_vertex V[3] = { clip_coords(v1), clip_coords(v2), clip_coords(v3) };
 
-	if (t1.z() > 0 || t2.z() > 0 || t3.z() > 0)
-		return;
-
-    vec2<double> c1 = cartesian_to_screen_coords(t1),
-                 c2 = cartesian_to_screen_coords(t2),
-                 c3 = cartesian_to_screen_coords(t3);
+	clip_rainbow(V);
 
-    return this->draw_rainbow_triangle(c1, c2, c3);
+	this->fill_clipped_triangle(V, RASTER_COLOR);
 }
 
 void window::draw_wireframe_polygon(polygon& p) {
@@ -1009,9 +1313,13 @@ void window::draw_wireframe_polygon(polygon& p) {
 void window::draw_filled_polygon(polygon& p) {
 	list<triangle> triangles = p.triangulated();
 
+	this->begin_batch();
+
 	for (int64_t k = 0; k < triangles.size(); k++) {
 		this->draw_filled_triangle(triangles[k]);
 	}
+
+	this->end_batch();
 }
 
 void window::draw_wireframe_polygon(polygon& p,
@@ -1053,10 +1361,15 @@ void window::draw_convex_hull(list<vec2<double>> &points,
 	int64_t N = points.size(), M = hull.size();
 
 	// Draws the entire set of points.
-	for (int64_t k = 0; k < N; k++) {
-		vec2<double> P = points[k];
-		this->draw_filled_circle(P, 2, norm);
-	}
+	std::vector<vec2<double>> markers(N);
+
+	linked_node<vec2<double>> *node = points.front();
+
+	for (int64_t k = 0; k < N; k++, node = node->next())
+		markers[k] = node->value();
+
+	this->set_render_color(norm);
+	this->draw_discs(markers.data(), N, 2);
 
 	// Draw convex hull.
 	for (int64_t k = 0; k < M; k++) {
@@ -1070,18 +1383,19 @@ void window::draw_convex_hull(list<vec2<double>> &points,
 void window::draw_convex_hull(list<vec3<double>> &points) {
 	list<triangle> hull = convex_hull::brute_force(points);
 
-	// Very temporary z-buffer hack.
-	quicksort(hull, &compare::tz);
-
 	int64_t M = hull.size();
 
 	linked_node<triangle> *node = hull.front();
 
+	this->begin_batch();
+
 	for (int64_t k = 0; k < M; k++) {
 		this->flat_shaded_triangle(node->value());
 
 		node = node->next();
 	}
+
+	this->end_batch();
 }
 
 void window::draw_convex_hull(list<vec3<double>> &points,
@@ -1090,32 +1404,424 @@ void window::draw_convex_hull(list<vec3<double>> &points,
 	this->draw_convex_hull(points);
 }
 
+void window::cache_vertex(int64_t k,
+						  const vec4<double>& clip) {
+	clip_vertex &C = this->clip_cache[k];
+
+	C.x = clip.x();
+	C.y = clip.y();
+	C.z = clip.z();
+	C.w = clip.w();
+
+	this->outcodes[k] = clip_outcode(C, this->guard);
+
+	// Only read for primitives that need no clipping, so w > 0.
+	if (C.w > 0)
+		this->screen_cache[k] = clip_to_raster(C);
+}
+
+void window::reserve_cache(int64_t N) {
+	this->clip_cache.resize(N);
+	this->screen_cache.resize(N);
+	this->outcodes.resize(N);
+}
+
+// Transforms every mesh vertex once into the clip, screen and outcode caches.
+void window::transform_vertices(const mesh &m) {
+	PROFILE_SCOPE(this->profile, STAGE_TRANSFORM);
+
+	const mat4<double> &view_proj = cam->view_projection();
+	int64_t N = m.vertex_count();
+
+	this->reserve_cache(N);
+	this->position_cache.resize(N);
+
+	linked_node<vec4<double>> *node = m.vertices().front();
+
+	for (int64_t k = 0; k < N; k++) {
+		const vec4<double> &p = node->value();
+
+		this->position_cache[k] = vec3<double>(p.x() / p.w(), p.y() / p.w(), p.z() / p.w());
+		this->cache_vertex(k, view_proj * p);
+		node = node->next();
+	}
+}
+
+void window::transform_vertices(const vec3<double> *positions,
+								const color *colors,
+								int64_t N) {
+	PROFILE_SCOPE(this->profile, STAGE_TRANSFORM);
+
+	const mat4<double> &view_proj = cam->view_projection();
+
+	this->reserve_cache(N);
+
+	for (int64_t k = 0; k < N; k++) {
+		clip_vertex &C = this->clip_cache[k];
+
+		if (colors) {
+			C.v[0] = colors[k].R();
+			C.v[1] = colors[k].G();
+			C.v[2] = colors[k].B();
+		}
+
+		this->cache_vertex(k, view_proj * vec4<double>(positions[k], 1.0));
+	}
+}
+
+void window::fill_cached_triangle(int64_t A,
+								  int64_t B,
+								  int64_t C,
+								  raster_shading shading,
+								  const vec2<double> *uv) {
+	int64_t codes = this->outcodes[A] | this->outcodes[B] | this->outcodes[C];
+
+	if (this->outcodes[A] & this->outcodes[B] & this->outcodes[C] & CLIP_VIEW_MASK) {
+		PROFILE_COUNT(this->profile, COUNT_CULLED, 1);
+		return;
+	}
+
+	if (codes & CLIP_GUARD_MASK) {
+		clip_vertex V[3] = { this->clip_cache[A], this->clip_cache[B], this->clip_cache[C] };
+
+		for (int64_t k = 0; uv && k < 3; k++) {
+			V[k].v[0] = uv[k].x();
+			V[k].v[1] = uv[k].y();
+		}
+
+		this->fill_clipped_triangle(V, shading);
+	} else {
+		raster_vertex R[3] = { this->screen_cache[A], this->screen_cache[B], this->screen_cache[C] };
+
+		for (int64_t k = 0; uv && k < 3; k++) {
+			R[k].v[0] = uv[k].x();
+			R[k].v[1] = uv[k].y();
+		}
+
+		this->fill_triangle(R, shading, true);
+	}
+}
+
+// Runs as separate cull, shading and raster passes over the faces so each
+// stage is timed once per mesh rather than once per face.
 void window::draw_mesh(mesh &m) {
-	list<triangle> &faces = m.faces();
-	quicksort(faces, &compare::tz);
+	PROFILE_COUNT(this->profile, COUNT_SUBMITTED, m.face_count());
+
+	{
+		PROFILE_SCOPE(this->profile, STAGE_CULL);
+
+		if (this->frustum_version != cam->version()) {
+			this->view_frustum = frustum(cam->view_projection());
+			this->frustum_version = cam->version();
+		}
+
+		if (!this->view_frustum.sphere_visible(m.bounding_center(), m.bounding_radius()) ||
+			!this->view_frustum.box_visible(m.aabb_min(), m.aabb_max())) {
+			PROFILE_COUNT(this->profile, COUNT_CULLED, m.face_count());
+			return;
+		}
+	}
+
+	this->transform_vertices(m);
+
+	{
+		PROFILE_SCOPE(this->profile, STAGE_CULL);
+
+		linked_node<vec3<int64_t>> *map_node = m.mappings().front();
+
+		this->visible.clear();
+
+		for (int64_t k = 0; k < m.face_count(); k++) {
+			vec3<int64_t> map = map_node->value();
+			map_node = map_node->next();
+
+			int64_t A = map[0], B = map[1], C = map[2];
 
-	linked_node<triangle> *face_node = faces.front();
+			if (this->outcodes[A] & this->outcodes[B] & this->outcodes[C] & CLIP_VIEW_MASK) {
+				PROFILE_COUNT(this->profile, COUNT_CULLED, 1);
+				continue;
+			}
+
+			// Faces are culled on the indexed vertices, since triangle re-sorts
+			// its corners and loses the winding.
+			if (this->culling) {
+				clip_vertex V[3] = { this->clip_cache[A], this->clip_cache[B], this->clip_cache[C] };
+				double winding = clip_winding(V);
+
+				if (this->front_face == WINDING_CW)
+					winding = -winding;
+
+				if (winding <= 0) {
+					++this->culled;
+					PROFILE_COUNT(this->profile, COUNT_CULLED, 1);
+					continue;
+				}
+			}
+
+			this->visible.push_back({ A, B, C, k, color() });
+		}
+	}
+
+	const bool textured = (this->state.tex && m.has_uvs());
+	const shading_mode mode = (textured ? SHADING_FLAT : this->state.shading);
+
+	{
+		PROFILE_SCOPE(this->profile, STAGE_SHADING);
+
+		const vec3<double> eye = cam->pos();
+		color curr = this->state.current;
+		light_batch &L = this->batch;
+
+		this->lights->update(eye);
 
-	color curr = *(this->current_color);
+		if (mode == SHADING_PHONG) {
+			const std::vector<vec3<double>> &normals = m.vertex_normals();
 
-	for (int64_t k = 0; k < m.face_count(); k++) {
-		triangle T = face_node->value();
-		vec3<double> N = T.normal(),
-					 v1 = T.v1(),
-					 v2 = T.v2(),
-					 v3 = T.v3();
+			this->lighting = this->lights->lighting(curr);
 
-		color diffuse = light::diffuse(l->norm_pos(), N, curr);
+			for (int64_t k = 0; k < m.vertex_count(); k++) {
+				const vec3<double> &N = normals[k];
+				vec3<double> E = eye - this->position_cache[k];
 
-		this->set_render_color(diffuse, false);
-		this->draw_filled_triangle(v1, v2, v3);
+				float attributes[6] = { (float) N.x(), (float) N.y(), (float) N.z(),
+										(float) E.x(), (float) E.y(), (float) E.z() };
+				float *v = this->clip_cache[k].v, *s = this->screen_cache[k].v;
+
+				for (int64_t j = 0; j < 6; j++)
+					v[j] = s[j] = attributes[j];
+			}
+		} else if (mode == SHADING_GOURAUD) {
+			const std::vector<vec3<double>> &normals = m.vertex_normals();
+
+			L.resize(m.vertex_count());
+
+			for (int64_t k = 0; k < m.vertex_count(); k++)
+				L.set(k, normals[k], eye - this->position_cache[k]);
+
+			this->lights->diffuse(L);
+
+			for (int64_t k = 0; k < m.vertex_count(); k++) {
+				color lit = lit_color(curr, L, k);
+				float *v = this->clip_cache[k].v, *s = this->screen_cache[k].v;
+
+				v[0] = s[0] = lit.R();
+				v[1] = s[1] = lit.G();
+				v[2] = s[2] = lit.B();
+			}
+		} else {
+			const std::vector<vec3<double>> &normals = m.face_normals();
+			const std::vector<vec3<double>> &P = this->position_cache;
+
+			int64_t N = this->visible.size();
+
+			L.resize(N);
+
+			// Faces are lit at their centroid.
+			for (int64_t k = 0; k < N; k++) {
+				const visible_face &F = this->visible[k];
+				L.set(k, normals[F.face], eye - (P[F.A] + P[F.B] + P[F.C]) / 3.0);
+			}
 
-		face_node = face_node->next();
+			this->lights->diffuse(L);
+
+			for (int64_t k = 0; k < N; k++)
+				this->visible[k].lit = lit_color(curr, L, k);
+		}
+	}
+
+	PROFILE_SCOPE(this->profile, STAGE_RASTER);
+
+	this->begin_batch();
+
+	raster_shading shading = (textured ? RASTER_TEXTURE :
+							  mode == SHADING_PHONG ? RASTER_PHONG :
+							  mode == SHADING_GOURAUD ? RASTER_COLOR : RASTER_FLAT);
+
+	const std::vector<vec2<double>> &uvs = m.uvs();
+	const std::vector<vec3<int64_t>> &uv_map = m.uv_mappings();
+	const int64_t U = uvs.size();
+
+	for (const visible_face &F : this->visible) {
+		if (mode == SHADING_FLAT)
+			this->set_render_color(F.lit, false);
+
+		if (textured) {
+			vec3<int64_t> T = uv_map[F.face];
+			vec2<double> uv[3];
+
+			// OBJ puts v = 0 at the bottom of the image, textures at the top.
+			for (int64_t k = 0; k < 3; k++)
+				if (T[k] >= 0 && T[k] < U)
+					uv[k] = vec2<double>(uvs[T[k]].x(), 1.0 - uvs[T[k]].y());
+
+			this->fill_cached_triangle(F.A, F.B, F.C, shading, uv);
+		} else {
+			this->fill_cached_triangle(F.A, F.B, F.C, shading);
+		}
 	}
 
+	this->end_batch();
 }
 
 void window::draw_mesh(mesh &m, color &c) {
 	this->set_render_color(c);
 	this->draw_mesh(m);
 }
+
+void window::draw_points(const vec3<double> *positions,
+						 int64_t N,
+						 const color *colors) {
+	this->transform_vertices(positions, colors, N);
+
+	for (int64_t k = 0; k < N; k++)
+		this->draw_cached_point(k, colors);
+}
+
+void window::draw_points(const vec3<double> *positions,
+						 int64_t N,
+						 const int64_t *indices,
+						 int64_t I,
+						 const color *colors) {
+	this->transform_vertices(positions, colors, N);
+
+	for (int64_t k = 0; k < I; k++)
+		this->draw_cached_point(indices[k], colors);
+}
+
+void window::draw_cached_point(int64_t A,
+							   const color *colors) {
+	if (this->outcodes[A] & CLIP_VIEW_MASK)
+		return;
+
+	const raster_vertex &P = this->screen_cache[A];
+
+	this->plot(std::floor(P.x), std::floor(P.y), (colors ? pack_color(colors[A]) : this->state.draw));
+}
+
+void window::draw_lines(const vec3<double> *positions,
+						int64_t N,
+						const color *colors) {
+	this->transform_vertices(positions, colors, N);
+
+	for (int64_t k = 0; k + 1 < N; k += 2)
+		this->draw_cached_line(k, k + 1, colors != nullptr);
+}
+
+void window::draw_lines(const vec3<double> *positions,
+						int64_t N,
+						const int64_t *indices,
+						int64_t I,
+						const color *colors) {
+	this->transform_vertices(positions, colors, N);
+
+	for (int64_t k = 0; k + 1 < I; k += 2)
+		this->draw_cached_line(indices[k], indices[k + 1], colors != nullptr);
+}
+
+void window::draw_lines(const vec2<double> *points,
+						int64_t N,
+						const color *colors) {
+	raster_segment S;
+
+	S.c1 = S.c2 = this->state.draw;
+
+	for (int64_t k = 0; k + 1 < N; k += 2) {
+		S.x1 = points[k].x();
+		S.y1 = points[k].y();
+		S.x2 = points[k + 1].x();
+		S.y2 = points[k + 1].y();
+
+		if (colors) {
+			S.c1 = pack_color(colors[k]);
+			S.c2 = pack_color(colors[k + 1]);
+		}
+
+		this->draw_segment(S);
+	}
+}
+
+void window::draw_discs(const vec2<double> *centers,
+						int64_t N,
+						double radius,
+						const color *colors,
+						bool smooth) {
+	raster_circle D;
+
+	D.r = radius;
+	D.c = this->state.draw;
+
+	for (int64_t k = 0; k < N; k++) {
+		D.x = centers[k].x();
+		D.y = centers[k].y();
+
+		if (colors)
+			D.c = pack_color(colors[k]);
+
+		this->draw_disc(D, smooth);
+	}
+}
+
+void window::draw_cached_line(int64_t A,
+							  int64_t B,
+							  bool colored) {
+	if (this->outcodes[A] & this->outcodes[B] & CLIP_VIEW_MASK)
+		return;
+
+	if ((this->outcodes[A] | this->outcodes[B]) & CLIP_VIEW_MASK) {
+		this->draw_clipped_line(this->clip_cache[A], this->clip_cache[B], colored);
+		return;
+	}
+
+	const raster_vertex &P = this->screen_cache[A], &Q = this->screen_cache[B];
+
+	raster_segment S;
+
+	S.x1 = P.x;
+	S.y1 = P.y;
+	S.x2 = Q.x;
+	S.y2 = Q.y;
+	S.c1 = S.c2 = this->state.draw;
+
+	if (colored) {
+		const float *a = this->clip_cache[A].v, *b = this->clip_cache[B].v;
+
+		S.c1 = pack_color(color(a[0], a[1], a[2]));
+		S.c2 = pack_color(color(b[0], b[1], b[2]));
+	}
+
+	this->draw_segment(S);
+}
+
+void window::draw_triangles(const vec3<double> *positions,
+							int64_t N,
+							const color *colors) {
+	this->transform_vertices(positions, colors, N);
+
+	PROFILE_COUNT(this->profile, COUNT_SUBMITTED, N / 3);
+	PROFILE_SCOPE(this->profile, STAGE_RASTER);
+
+	this->begin_batch();
+
+	for (int64_t k = 0; k + 2 < N; k += 3)
+		this->fill_cached_triangle(k, k + 1, k + 2, (colors ? RASTER_COLOR : RASTER_FLAT));
+
+	this->end_batch();
+}
+
+void window::draw_triangles(const vec3<double> *positions,
+							int64_t N,
+							const int64_t *indices,
+							int64_t I,
+							const color *colors) {
+	this->transform_vertices(positions, colors, N);
+
+	PROFILE_COUNT(this->profile, COUNT_SUBMITTED, I / 3);
+	PROFILE_SCOPE(this->profile, STAGE_RASTER);
+
+	this->begin_batch();
+
+	for (int64_t k = 0; k + 2 < I; k += 3)
+		this->fill_cached_triangle(indices[k], indices[k + 1], indices[k + 2], (colors ? RASTER_COLOR : RASTER_FLAT));
+
+	this->end_batch();
+}
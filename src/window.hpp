@@ -4,23 +4,32 @@
 #pragma once
 #include "bezier.hpp"
 #include "camera.hpp"
+#include "clipper.hpp"
 #include "color.hpp"
+#include "command_buffer.hpp"
 #include "convex_hull.hpp"
+#include "frame_pacer.hpp"
+#include "framebuffer.hpp"
+#include "frustum.hpp"
 #include "light.hpp"
+#include "light_list.hpp"
 #include "mat.hpp"
 #include "mesh.hpp"
 #include "polygon.hpp"
+#include "profiler.hpp"
+#include "rasterizer.hpp"
+#include "render_target.hpp"
+#include "texture.hpp"
+#include "tile_renderer.hpp"
 #include "triangle.hpp"
 #include "vec.hpp"
 
 #include <SDL2/SDL.h>
 
-#define RENDERER_DELAY 15
 #define DEFAULT_WINDOW_WIDTH 500
 #define DEFAULT_WINDOW_HEIGHT 500
 #define DEFAULT_NEAR_DISTANCE 0.1
 #define DEFAULT_FAR_DISTANCE 100
-#define DEFAULT_Z_THRESH 0.125
 #define CAMERA_SPEED 0.0625
 
 double relative_line_distance(const vec2<double>& A, 
@@ -31,27 +40,130 @@ color interpolate_color(color& c1,
                         color& c2,
                         const double P);
 
+enum render_mode {
+	// Every triangle is rasterized as soon as it is drawn.
+	RENDER_IMMEDIATE,
+	// Meshes, 3D hulls and polygons are binned into tiles and rasterized
+	// on a worker pool once the whole primitive has been submitted.
+	RENDER_TILED
+};
+
+enum blend_mode {
+	BLEND_NONE,
+	// Source over by the draw color's alpha. Blended triangles test depth
+	// but do not write it.
+	BLEND_ALPHA
+};
+
+enum shading_mode {
+	// One light::diffuse color per face.
+	SHADING_FLAT,
+	// Each vertex is lit once per draw from its averaged normal and the
+	// colors are interpolated across the faces.
+	SHADING_GOURAUD,
+	// Normals and eye vectors are interpolated and lit per pixel, with
+	// Blinn-Phong highlights from each light's specular color.
+	SHADING_PHONG
+};
+
+enum line_mode {
+	// Bresenham, one pixel per step along the major axis.
+	LINE_ALIASED,
+	// Xiaolin Wu, two pixels per step blended by coverage whatever the
+	// blend mode.
+	LINE_SMOOTH
+};
+
+// Draw state held by value. Setting a value already held is skipped and
+// not counted as a change.
+struct render_state {
+	// Base color that meshes shade from.
+	color current;
+	// Packed color primitives are drawn with.
+	uint32_t draw = 0xFF000000;
+	blend_mode blend = BLEND_NONE;
+	shading_mode shading = SHADING_FLAT;
+	line_mode line = LINE_ALIASED;
+	// Not owned.
+	const texture *tex = nullptr;
+	texture_filter filter = FILTER_TRILINEAR;
+};
+
+// Winding of front faces, seen in NDC as in OpenGL.
+enum face_winding {
+	WINDING_CCW,
+	WINDING_CW
+};
+
 class window {
     private:
-		light *l = nullptr;
+		light_list *lights = nullptr;
         camera *cam = nullptr;
-		mat4<double> *view_mat;
 
         bool init = false, quit = false, paused = false, modified = true;
 
         int64_t width = DEFAULT_WINDOW_WIDTH, 
-                height = DEFAULT_WINDOW_HEIGHT, 
-				delay = RENDERER_DELAY;
+                height = DEFAULT_WINDOW_HEIGHT;
+
+		frame_pacer pacer;
 
         int64_t global_time = 0;
-		color *current_color = nullptr;
+		render_state state;
+		int64_t state_changes_issued = 0, state_changes_last = 0;
+
+		framebuffer *fb = nullptr;
+		rasterizer *raster = nullptr;
+		tile_renderer *tiles = nullptr;
+		bool batching = false;
+		command_buffer *recording = nullptr;
+
+		// Rebuilt when the camera version moves on.
+		frustum view_frustum;
+		uint64_t frustum_version = UINT64_MAX;
+
+		// Last mesh transform, indexed like mesh::vertices().
+		std::vector<clip_vertex> clip_cache;
+		std::vector<raster_vertex> screen_cache;
+		std::vector<int64_t> outcodes;
+		// World positions, only for meshes.
+		std::vector<vec3<double>> position_cache;
+
+		bool culling = false;
+		face_winding front_face = WINDING_CCW;
+		int64_t culled = 0;
+
+		// Faces of the current mesh that survived culling, lit in a
+		// separate pass before any are rasterized.
+		struct visible_face {
+			int64_t A, B, C, face;
+			color lit;
+		};
+
+		std::vector<visible_face> visible;
 
-        SDL_Window *w;
-        SDL_Renderer *r;
+		// Lights of the current SHADING_PHONG mesh, pointed to by its
+		// triangles until they are flushed.
+		raster_lighting lighting;
+
+		// Vertices or faces lit in one pass over all lights.
+		light_batch batch;
+
+		profiler profile;
+
+		// Side plane guard band, narrowed for windows too large for it to
+		// stay within the rasterizer's coordinate range.
+		double guard = CLIP_GUARD_BAND;
+
+		// Depth-tested micro triangles deferred to the end of a batch.
+		std::vector<raster_triangle> micro;
+
+        render_target *target = nullptr;
         SDL_Event event;
 
         void initialize_window();
 
+		void initialize_framebuffer();
+
         void initialize_camera();
 
 		void initialize_light();
@@ -66,13 +178,93 @@ class window {
 		list<vec2<double>> cartesian_to_screen_coords(const list<vec3<double>> &points) const;
 
 		list<vec2<double>> cartesian_to_screen_coords(const list<vec4<double>> &points) const;
+
+		// World space to homogeneous clip space.
+		clip_vertex clip_coords(const vec4<double>& vert) const;
+
+		// Perspective divide and viewport transform, NDC depth kept in z.
+		raster_vertex clip_to_raster(const clip_vertex& vert) const;
+
+		// True when a view space point lies between the near and far planes.
+		bool depth_visible(const vec4<double>& view_vert) const;
+
+		void reserve_cache(int64_t N);
+
+		void cache_vertex(int64_t k,
+						  const vec4<double>& clip);
+
+		void transform_vertices(const mesh &m);
+
+		// Colors become varyings 0-2 when given.
+		void transform_vertices(const vec3<double> *positions,
+								const color *colors,
+								int64_t N);
+
+		// Triangles and lines between cached vertices; only the ones
+		// crossing a plane go through the clipper.
+		// uv, when given, replaces varyings 0..1 of the three corners.
+		void fill_cached_triangle(int64_t A,
+								  int64_t B,
+								  int64_t C,
+								  raster_shading shading,
+								  const vec2<double> *uv = nullptr);
+
+		void draw_cached_point(int64_t A,
+							   const color *colors);
+
+		void draw_cached_line(int64_t A,
+							  int64_t B,
+							  bool colored);
+
+		// Colored lines interpolate varyings 0-2.
+		void draw_clipped_line(clip_vertex a,
+							   clip_vertex b,
+							   bool colored = false);
+
+		// Clips, then fans the visible polygon into depth-tested triangles.
+		void fill_clipped_triangle(const clip_vertex V[3],
+								   raster_shading shading);
+
+		void fill_triangle(const raster_vertex V[3],
+						   raster_shading shading,
+						   bool depth_test);
+
+		// Records, queues or draws a set-up triangle.
+		void submit_triangle(const raster_triangle& T);
+
+		// Screen space pixels and lines, recorded when a buffer is open.
+		void plot(int64_t x, int64_t y, uint32_t c);
+
+		void draw_segment(const raster_segment& s);
+
+		void rasterize_line(const raster_segment& s,
+							bool blended,
+							bool smooth);
+
+		void draw_disc(const raster_circle& d,
+					   bool smooth);
+
+		void rasterize_disc(const raster_circle& d,
+							bool blended,
+							bool smooth);
+
+		// Triangles filled between these are queued for the tile renderer
+		// when it is active.
+		void begin_batch();
+
+		void end_batch();
     public:
         window();
 
         window(const int64_t W, const int64_t H);
 
+        // D is the frame budget in milliseconds; D <= 0 runs uncapped.
         window(const int64_t W, const int64_t H, const int64_t D);
 
+		// Presents into T, which the window takes ownership of. With a
+		// headless_target nothing touches SDL video. Starts uncapped.
+		window(render_target *T, const int64_t W, const int64_t H);
+
         ~window();
 
 		int64_t time() const;
@@ -83,6 +275,85 @@ class window {
 
         bool is_running() const;
 
+		// Forces the scalar triangle kernel and lighting pass when
+		// disabled, for comparing output against the SIMD paths.
+		void set_simd(bool enabled);
+
+		bool simd_enabled() const;
+
+		// threads <= 0 uses one worker per hardware thread.
+		void set_render_mode(render_mode mode,
+							 int64_t threads = 0);
+
+		render_mode mode() const;
+
+		// Meshes skip faces whose projected winding is opposite to front.
+		// Faces keep the winding of the mesh's index order.
+		void set_culling(bool enabled,
+						 face_winding front = WINDING_CCW);
+
+		bool culling_enabled() const;
+
+		// Faces culled since the last reset.
+		int64_t culled_faces() const;
+
+		void reset_culled_faces();
+
+		// fps <= 0 runs uncapped. Turns vsync off.
+		void set_frame_rate(double fps);
+
+		// Paces on the display refresh. Returns false, leaving pacing as
+		// it was, when the target cannot.
+		bool set_vsync(bool enabled);
+
+		frame_stats frame_times() const;
+
+		void set_blend_mode(blend_mode mode);
+
+		blend_mode get_blend_mode() const;
+
+		// Starts with one white directional light along +z. Changes are
+		// picked up by the next draw.
+		light_list& get_lights();
+
+		// Applies to draw_mesh. Flat by default.
+		void set_shading_mode(shading_mode mode);
+
+		shading_mode get_shading_mode() const;
+
+		// Meshes with texture coordinates are drawn with the texture,
+		// modulated by their per-face lighting, whatever the shading mode.
+		// The texture must outlive its draws; nullptr turns texturing off.
+		void set_texture(const texture *tex,
+						 texture_filter filter = FILTER_TRILINEAR);
+
+		const texture* get_texture() const;
+
+		// Applies to every line draw. Aliased by default.
+		void set_line_mode(line_mode mode);
+
+		line_mode get_line_mode() const;
+
+		// Color, blend, shading, texture and line mode changes actually
+		// issued during the last presented frame.
+		int64_t state_changes() const;
+
+		// Stage times and pipeline counters of the last presented frame,
+		// all zero when built with PROFILER_ENABLED=0. Only batched draws
+		// (meshes, the draw_* arrays, replay) are timed; every draw is
+		// counted.
+		const frame_profile& last_profile() const;
+
+		// Until end_recording, draws are captured into buffer after
+		// transform, clipping and set-up instead of touching the
+		// framebuffer. Background fills are not recorded.
+		void begin_recording(command_buffer& buffer);
+
+		void end_recording();
+
+		void replay(const command_buffer& buffer,
+					command_sort sort = SORT_SUBMISSION);
+
         void fill_background(color c);
 
         void draw_point(const vec2<double>& point);
@@ -142,6 +413,7 @@ class window {
                                    const double radius,
                                    color& c);
 
+		// Every pixel whose centre is inside the circle, once.
         void draw_filled_circle(const vec2<double>& center, 
                                 const double radius);
 
@@ -387,6 +659,53 @@ class window {
 
 		void draw_mesh(mesh &m, color &c);
 
+		// Batched submission of N world space positions, transformed once
+		// per call. Colors, when given, are per vertex: points take their
+		// own, and lines and triangles blend theirs. Indexed versions draw
+		// I indices into positions.
+		void draw_points(const vec3<double> *positions,
+						 int64_t N,
+						 const color *colors = nullptr);
+
+		void draw_points(const vec3<double> *positions,
+						 int64_t N,
+						 const int64_t *indices,
+						 int64_t I,
+						 const color *colors = nullptr);
+
+		void draw_lines(const vec3<double> *positions,
+						int64_t N,
+						const color *colors = nullptr);
+
+		void draw_lines(const vec3<double> *positions,
+						int64_t N,
+						const int64_t *indices,
+						int64_t I,
+						const color *colors = nullptr);
+
+		// Screen space lines between consecutive pairs of the N points.
+		void draw_lines(const vec2<double> *points,
+						int64_t N,
+						const color *colors = nullptr);
+
+		// Screen space discs of one radius around the N centers, as point
+		// markers. Smooth discs are anti-aliased and always blend.
+		void draw_discs(const vec2<double> *centers,
+						int64_t N,
+						double radius,
+						const color *colors = nullptr,
+						bool smooth = true);
+
+		void draw_triangles(const vec3<double> *positions,
+							int64_t N,
+							const color *colors = nullptr);
+
+		void draw_triangles(const vec3<double> *positions,
+							int64_t N,
+							const int64_t *indices,
+							int64_t I,
+							const color *colors = nullptr);
+
         void tick();
 
 		void present();